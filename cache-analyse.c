@@ -33,15 +33,34 @@
  * either expressed or implied, of the cache-analyse project.
  */
 
+#define _GNU_SOURCE
+
 #include "timer.h"
 #include "cycle.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <limits.h>
+#include <linux/perf_event.h>
 #include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
 #include <time.h>
 #include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
 
 #ifdef PAPI
 #include <papi.h>
@@ -63,42 +82,242 @@ char * EventStrings[3] = {"PAPI_TOT_CYC", "PAPI_L2_DCM", "PAPI_L2_DCA" };
 /***********************************************************************
  * data type definitions
  ***********************************************************************/
-/** data element */
+/** data element, the actual element size in the working set is elem_size */
 struct l {
   struct l *next; /**< pointer to next data element */
-  char pad[NPAD]; /**< padding */
 };
 typedef struct l list_elem;
 
+typedef list_elem* (*init_fct_ptr)(list_elem *, long);
+typedef long int (*test_fct_ptr)(long, list_elem *);
+
+/** access the i-th element of a working set with elements of elem_size Byte */
+#define ELEM(base, i) ((list_elem *) ((char *) (base) + (i) * elem_size))
+
 /***********************************************************************
  * definitions and default values
  ***********************************************************************/
-/* size of the allocated memory region used to clear CPU caches */
+/* minimum size of the eviction buffer used to clear CPU caches */
 #ifndef CLEAR_CACHE_BLOCK_SIZE
 #define CLEAR_CACHE_BLOCK_SIZE 16*1024*1024	// 16 MB
 #endif
 
-/* size of the padding used in the data stucture, actual size of data structure
- * may be lareger due to alignment by the compiler */
-#ifndef NPAD
-#define NPAD 0
+/* size of the eviction buffer as multiple of the last level cache size,
+ * the margin covers replacement policies which are not strictly LRU */
+#ifndef EVICT_BUFFER_FACTOR
+#define EVICT_BUFFER_FACTOR 1.25
+#endif
+
+/* cache line size used for the cacheline allocation policy */
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+/* number of accesses between two checks of the stop flag in threaded runs */
+#ifndef THREAD_CHUNK
+#define THREAD_CHUNK 1024
+#endif
+
+/* maximum number of CPUs which can be passed via --cpus */
+#ifndef MAX_CPUS
+#define MAX_CPUS 1024
+#endif
+
+/* maximum number of NUMA nodes considered by --numa-matrix */
+#ifndef MAX_NUMA_NODES
+#define MAX_NUMA_NODES 64
+#endif
+
+#ifndef MPOL_DEFAULT
+#define MPOL_DEFAULT 0
+#define MPOL_BIND 2
 #endif
 
+/* maximum number of independent pointer chains which can be chased at once */
+#ifndef MAX_CHAINS
+#define MAX_CHAINS 32
+#endif
+
+/* upper limit of repetitions per point when a confidence interval is targeted */
+#ifndef MAX_REPETITIONS
+#define MAX_REPETITIONS 100
+#endif
+
+/* random chains are generated as one single cycle per chunk of this size,
+ * in parallel if there are several, the chunks being much larger than any
+ * cache. It fixes the chain of a seed and size on every machine. */
+#ifndef INIT_CHUNK_SIZE
+#define INIT_CHUNK_SIZE (1L << 28) // 256 MB
+#endif
+
+/* trace entries replayed per point, which bounds both the memory for the
+ * folded offsets and the time of a point for traces of any length */
+#ifndef TRACE_WINDOW
+#define TRACE_WINDOW (1L << 22) // 16 MB of offsets
+#endif
+
+/* maximum number of threads generating a random chain */
+#ifndef MAX_INIT_THREADS
+#define MAX_INIT_THREADS 64
+#endif
+
+/* maximum number of element sizes which can be passed via -e */
+#ifndef MAX_ELEM_SIZES
+#define MAX_ELEM_SIZES 64
+#endif
+
+/* minimum number of accesses per element of the working set in each point */
 #ifndef NUM_ACCESS_FACTOR 
 #define NUM_ACCESS_FACTOR 2
 #endif
 
+/* time over which the time stamp counter is calibrated against the clock */
+#ifndef TSC_CALIBRATION_TIME
+#define TSC_CALIBRATION_TIME 0.05
+#endif
+
+/* number of empty measurements to determine the timing overhead */
+#ifndef OVERHEAD_SAMPLES
+#define OVERHEAD_SAMPLES 100
+#endif
+
+/* maximum number of hardware events which can be passed via --events */
+#ifndef MAX_EVENTS
+#define MAX_EVENTS 16
+#endif
+
+/* number of events counted together in one event group, should not exceed
+ * the number of hardware counters */
+#ifndef EVENTS_PER_GROUP
+#define EVENTS_PER_GROUP 4
+#endif
+
+/* fraction of the time per point used to calibrate the number of accesses */
+#ifndef CALIBRATION_FRACTION
+#define CALIBRATION_FRACTION 0.1
+#endif
+
+/* size of a single data element incl. padding, set for each entry of elem_sizes */
+long int elem_size = sizeof(list_elem);
+long int elem_sizes[MAX_ELEM_SIZES] = { sizeof(list_elem) };
+int num_elem_sizes = 1;
+
 /* working set minimum and maximum size */
-long int wset_start_size = sizeof(list_elem);	// minimum is size of list_elem
+long int wset_start_size = sizeof(list_elem);	// minimum is size of one element
 long int wset_final_size = 1 << 27;	// 128 MB
 long int wset_stride = 1; // stride between elements in array to be considered
                           // For stride 2  elements 0, 2, 4, 6, ... will be used for access
 
+/* distance between the elements of the page patterns, one element per page */
+long int page_stride = 4096;
+
+/* number of elements of the chain of the current point */
+long int chain_length = 1;
+
+/* trace pattern: memory-mapped file of 64 bit offsets or addresses, its
+ * number of entries and the smallest and largest entry */
+const char *trace_file = NULL;
+const uint64_t *trace_entries = NULL;
+long int trace_len = 0;
+uint64_t trace_min = 0, trace_max = 0;
+
+/* trace replay: the first trace_window entries of the trace folded into the
+ * working set of the current point as element indices and the position of
+ * the next access in them */
+uint32_t *trace_offsets = NULL;
+long int trace_window = 0;
+long int trace_pos = 0;
+
+/* allocation policy for the working set memory */
+typedef enum {
+  ALLOC_MALLOC,    /**< plain malloc */
+  ALLOC_CACHELINE, /**< posix_memalign to CACHE_LINE_SIZE */
+  ALLOC_PAGE,      /**< posix_memalign to the page size */
+  ALLOC_HUGE_2M,   /**< mmap with MAP_HUGETLB using 2 MB pages */
+  ALLOC_HUGE_1G,   /**< mmap with MAP_HUGETLB using 1 GB pages */
+  ALLOC_THP        /**< 2 MB aligned memory with madvise(MADV_HUGEPAGE) */
+} alloc_policy_t;
+const char *alloc_policy_names[] = { "malloc", "cacheline", "page", "hugetlb-2M", "hugetlb-1G", "thp" };
+alloc_policy_t alloc_policy = ALLOC_MALLOC;
+
+/* how the caches are prepared before the cold traversal of each point */
+typedef enum {
+  FLUSH_EVICT,      /**< write an eviction buffer larger than the last level cache */
+  FLUSH_CLFLUSH,    /**< clflush all lines of the working set */
+  FLUSH_CLFLUSHOPT, /**< clflushopt all lines of the working set */
+  FLUSH_WARM        /**< untimed traversal of the working set */
+} flush_mode_t;
+const char *flush_mode_names[] = { "evict", "clflush", "clflushopt", "warm" };
+flush_mode_t flush_mode = FLUSH_EVICT;
+long *evict_buffer = NULL;
+long int evict_size = 0;
+
+/* memory reused by the working sets of all points, prefaulted and
+ * optionally locked */
+char *arena = NULL;
+long int arena_size = 0;
+int arena_mlock = 0;
+
+/* number of independent chains chased at once, set for each entry of chain_counts */
+int num_chains = 1;
+int chain_counts[MAX_CHAINS] = { 1 };
+int num_chain_counts = 1;
+list_elem *chain_heads[MAX_CHAINS];
+
+/* threaded runs: number of threads (0 = single threaded), CPUs to pin the
+ * threads to and whether all threads share one chain */
+int num_threads = 0;
+int thread_cpus[MAX_CPUS];
+int num_thread_cpus = 0;
+int shared_chain = 0;
+
+/* targeted time per measurement in seconds, the number of accesses is
+ * calibrated to it for every working set size */
+double point_duration = 0.05;
+
+/* distance in accesses of the software prefetches of the prefetch kernel */
+long int prefetch_distance = 8;
+
+/* time stamp counter frequency in GHz, calibrated at startup */
+double tsc_ghz = 1.;
+
+/* keeps the result of calibration runs alive */
+volatile long int calibration_sink;
+
+/* seed of the random chains, each chain is derived from it and its size */
+uint64_t random_seed = 1;
+
+/* measurements per point and targeted relative width of the 95% confidence
+ * interval, additional measurements are done until it is reached */
+int repetitions = 1;
+double ci_target = 0.;
+
+/* detect the cache levels at the end of each sweep */
+int detect_cache_levels = 0;
+
+/* bandwidth runs: instruction set (index into bw_isas) and whether to use
+ * non-temporal stores */
+int bw_isa = -1;
+int bw_nt = 0;
+
 #ifndef SMALL_ARRAY_LIMIT
 #define SMALL_ARRAY_LIMIT (1024)
 #endif
 double factor = 1.05;
 
+/* adaptive sweep: a coarse pass growing by ADAPTIVE_COARSE_FACTOR over the
+ * grid of powers of factor, whose intervals are bisected on the grid while
+ * the latency changes by more than the relative threshold and they are
+ * wider than one step, 0 disables it */
+#ifndef ADAPTIVE_COARSE_FACTOR
+#define ADAPTIVE_COARSE_FACTOR 1.5
+#endif
+double adaptive_threshold = 0.;
+
 FILE *logfile;
 
 /***********************************************************************
@@ -133,246 +352,4866 @@ int papi_error_handler (int retval) {
 }
 #endif
 
+long int sysfs_cache_size(int level);
+
+/**
+ * Allocate the eviction buffer of EVICT_BUFFER_FACTOR times the size of the
+ * last level cache reported by sysfs, at least CLEAR_CACHE_BLOCK_SIZE Byte.
+ * @return 0 on success, 1 otherwise
+ */
+int alloc_evict_buffer(){
+	long int llc_size = 0;
+	int level;
+
+	for( level = 1; level <= 4; level++ ) {
+		long int cache_size = sysfs_cache_size( level );
+		if( cache_size > llc_size )
+			llc_size = cache_size;
+	}
+	evict_size = (long int) (EVICT_BUFFER_FACTOR * llc_size) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+	if( evict_size < CLEAR_CACHE_BLOCK_SIZE )
+		evict_size = CLEAR_CACHE_BLOCK_SIZE;
+	evict_buffer = (long *) malloc( evict_size );
+	if( evict_buffer == NULL ) {
+		fprintf(stderr, "ERROR: Could not allocate eviction buffer of %ld Bytes\n", evict_size);
+		return 1;
+	}
+	memset( evict_buffer, 0, evict_size );
+	return 0;
+}
+
+/** @return whether the CPU supports the clflushopt instruction */
+int clflushopt_supported(){
+#if defined(__x86_64__) || defined(__i386__)
+	unsigned int eax, ebx, ecx, edx;
+	return __get_cpuid_count( 7, 0, &eax, &ebx, &ecx, &edx ) && (ebx & bit_CLFLUSHOPT);
+#else
+	return 0;
+#endif
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+static __attribute__((target("clflushopt"))) void flush_lines_opt(const char *mem, long int size){
+	long int i;
+	for( i = 0; i < size; i += CACHE_LINE_SIZE )
+		_mm_clflushopt( (void *) (mem + i) );
+	_mm_sfence();
+}
+#endif
+
+/**
+ * Clear the CPU caches before a measurement following flush_mode. The
+ * working set of size Byte at mem is flushed line by line or the caches
+ * are filled with modified lines of the eviction buffer. Nothing is done in
+ * warm mode, where the caller traverses the working set instead.
+ */
+void clear_cache(const void *mem, long int size){
+	const long int step = CACHE_LINE_SIZE / sizeof(long);
+	long int i;
+
+	switch( flush_mode ) {
+		case FLUSH_EVICT:
+			for( i = 0; i < evict_size / (long) sizeof(long); i += step )
+				evict_buffer[i]++;
+			break;
+#if defined(__x86_64__) || defined(__i386__)
+		case FLUSH_CLFLUSH:
+			for( i = 0; i < size; i += CACHE_LINE_SIZE )
+				_mm_clflush( (const char *) mem + i );
+			_mm_mfence();
+			break;
+		case FLUSH_CLFLUSHOPT:
+			flush_lines_opt( (const char *) mem, size );
+			break;
+#else
+		/* rejected at startup */
+		case FLUSH_CLFLUSH:
+		case FLUSH_CLFLUSHOPT:
+#endif
+		case FLUSH_WARM:
+			break;
+	}
+}
+
+/**
+ * Huge page size used by the allocation policy, 0 for policies using the
+ * regular page size.
+ */
+static long int alloc_huge_page_size(){
+	switch( alloc_policy ) {
+		case ALLOC_HUGE_2M:
+		case ALLOC_THP:
+			return 1L << 21;
+		case ALLOC_HUGE_1G:
+			return 1L << 30;
+		default:
+			return 0;
+	}
+}
+
+/**
+ * Allocate memory for a working set of size Byte plus one spare element
+ * following the current allocation policy.
+ * @return pointer to the memory, NULL in case of an error
+ */
+void * alloc_wset(long int size){
+	void *ptr = NULL;
+	long int hpage = alloc_huge_page_size();
+	int ret = 0;
+
+	size += elem_size;
+	switch( alloc_policy ) {
+		case ALLOC_MALLOC:
+			ptr = malloc( size );
+			break;
+		case ALLOC_CACHELINE:
+			ret = posix_memalign( &ptr, CACHE_LINE_SIZE, size );
+			break;
+		case ALLOC_PAGE:
+			ret = posix_memalign( &ptr, sysconf(_SC_PAGESIZE), size );
+			break;
+		case ALLOC_HUGE_2M:
+		case ALLOC_HUGE_1G:
+			size = (size + hpage - 1) / hpage * hpage;
+			ptr = mmap( NULL, size, PROT_READ | PROT_WRITE,
+			            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (__builtin_ctzl(hpage) << MAP_HUGE_SHIFT), -1, 0 );
+			if( ptr == MAP_FAILED ) {
+				ret = errno;
+				ptr = NULL;
+			}
+			break;
+		case ALLOC_THP:
+			size = (size + hpage - 1) / hpage * hpage;
+			ret = posix_memalign( &ptr, hpage, size );
+			if( ret == 0 && madvise( ptr, size, MADV_HUGEPAGE ) != 0 )
+				fprintf(stderr, "WARNING: madvise(MADV_HUGEPAGE) failed: %s\n", strerror(errno));
+			break;
+	}
+	if( ret != 0 ) {
+		fprintf(stderr, "ERROR: Allocation of %ld Bytes with policy %s failed: %s\n", size, alloc_policy_names[alloc_policy], strerror(ret));
+		return NULL;
+	}
+	return ptr;
+}
+
 /**
- * Clear the CPU cache by accessing all elements of an large array.
- * @return random int computed from the uninitialized memory
+ * Release a working set allocated with alloc_wset(size).
  */
-int clear_cache(){
-  const long int num_ints = (CLEAR_CACHE_BLOCK_SIZE + sizeof(int)) / sizeof(int);
-  long int i;
-  long int value = 0;
-  int * large_mem;
+void free_wset(void *ptr, long int size){
+	long int hpage = alloc_huge_page_size();
 
-  large_mem = (int *)malloc (num_ints * sizeof(int));
-  if (large_mem == NULL)
-    return 0;
+	if( ptr == NULL )
+		return;
+	if( alloc_policy == ALLOC_HUGE_2M || alloc_policy == ALLOC_HUGE_1G ) {
+		size += elem_size;
+		munmap( ptr, (size + hpage - 1) / hpage * hpage );
+	}
+	else {
+		free( ptr );
+	}
+}
 
-  for (i=0; i < num_ints; i++)
-    value += large_mem[i];
-  free( large_mem );
+/**
+ * Allocate the arena for working sets of up to wset_final_size Byte with any
+ * of the element sizes and fault in all of its pages, so that all points of
+ * a sweep use the same physical memory.
+ * @return 0 on success, 1 otherwise
+ */
+int alloc_arena(){
+	long int spare = 3 * CACHE_LINE_SIZE; /* alignment of the bandwidth arrays */
+	int e;
 
-  return value;
+	for( e = 0; e < num_elem_sizes; e++ )
+		if( elem_sizes[e] > spare )
+			spare = elem_sizes[e];
+	arena_size = wset_final_size + spare;
+	arena = (char *) alloc_wset( arena_size );
+	if( arena == NULL )
+		return 1;
+	memset( arena, 0, arena_size );
+	if( arena_mlock && mlock( arena, arena_size ) != 0 )
+		fprintf(stderr, "WARNING: mlock of %ld Bytes failed: %s\n", arena_size, strerror(errno));
+	return 0;
 }
 
 /**
- * Allocate an array of 'list_elem'ents with at least size size Byte.
- * The list elements are connected in a sequential round robing way.
- * @return pointer to the begin of array, NULL in case of an error
+ * Build a chain of 'list_elem'ents in the memory at wsetptr of at least
+ * size size Byte. The list elements are connected in a sequential round
+ * robing way.
+ * @return wsetptr, NULL if wsetptr is NULL
  */
-list_elem * init_sequential(long int size){
+list_elem * init_sequential(list_elem *wsetptr, long int size){
 	long int i;
-	list_elem *wsetptr;
 
-	wsetptr = (list_elem *) malloc(size + sizeof(list_elem));
 	if( wsetptr == NULL )
 		return NULL;
 	/* initialize the linear pointer chain */
-	long num_elem = size / sizeof(list_elem);
+	long num_elem = size / elem_size;
 
 	for( i = 0; i < num_elem - wset_stride; i += wset_stride )
-		wsetptr[i].next = &wsetptr[i+wset_stride];
-	wsetptr[i].next = &wsetptr[0]; // last element points to the first one
+		ELEM(wsetptr, i)->next = ELEM(wsetptr, i+wset_stride);
+	ELEM(wsetptr, i)->next = ELEM(wsetptr, 0); // last element points to the first one
 	
 	return wsetptr;
 }
 
 /**
- * Allocate an array of 'list_elem'ents with at least size size Byte.
- * The list elements are connected in an inverse sequential round robing way.
- * @return pointer to the begin of array, NULL in case of an error
+ * Build a chain of 'list_elem'ents in the memory at wsetptr of at least
+ * size size Byte. The list elements are connected in an inverse sequential
+ * round robing way.
+ * @return wsetptr, NULL if wsetptr is NULL
  */
-list_elem * init_inverse_sequential(long int size){
+list_elem * init_inverse_sequential(list_elem *wsetptr, long int size){
 	long int i;
-	list_elem *wsetptr;
 
-	wsetptr = (list_elem *) malloc(size + sizeof(list_elem));
 	if( wsetptr == NULL )
 		return NULL;
 	/* initialize the linear pointer chain */
-	for( i = wset_stride; i < size / sizeof(list_elem); i+=wset_stride )
-		wsetptr[i].next = &wsetptr[i-wset_stride];
-	wsetptr[0].next = &wsetptr[i-wset_stride]; // first element points to the last one
+	for( i = wset_stride; i < size / elem_size; i+=wset_stride )
+		ELEM(wsetptr, i)->next = ELEM(wsetptr, i-wset_stride);
+	ELEM(wsetptr, 0)->next = ELEM(wsetptr, i-wset_stride); // first element points to the last one
 	
 	return wsetptr;
 }
 
+/** state of the xoshiro256** pseudo random number generator */
+typedef struct {
+	uint64_t s[4];
+} rng_t;
+
+static uint64_t splitmix64(uint64_t *x){
+	uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/** Seed the generator state from a single number with splitmix64. */
+static void rng_seed(rng_t *rng, uint64_t seed){
+	int i;
+	for( i = 0; i < 4; i++ )
+		rng->s[i] = splitmix64( &seed );
+}
+
+static inline uint64_t rotl64(uint64_t x, int k){
+	return (x << k) | (x >> (64 - k));
+}
+
+/** @return next 64 bit number of the xoshiro256** generator */
+static inline uint64_t rng_next(rng_t *rng){
+	uint64_t *s = rng->s;
+	const uint64_t result = rotl64(s[1] * 5, 7) * 9;
+	const uint64_t t = s[1] << 17;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl64(s[3], 45);
+	return result;
+}
+
 /**
- * Allocate an array of 'list_elem'ents with at least size size Byte.
- * The list elements are connected in a random round robing way where
- * only elements with index multiple of stride are connected.
- * @return pointer to the begin of array, NULL in case of an error
+ * Unbiased random number by Lemire's multiply and reject method.
+ * @return uniformly distributed number in [0, range)
  */
-list_elem * init_random(long int size){
-	long int i;
-	list_elem *wsetptr;
+static inline uint64_t rng_below(rng_t *rng, uint64_t range){
+	unsigned __int128 m = (unsigned __int128) rng_next(rng) * range;
+	if( (uint64_t) m < range ) {
+		const uint64_t threshold = -range % range;
+		while( (uint64_t) m < threshold )
+			m = (unsigned __int128) rng_next(rng) * range;
+	}
+	return (uint64_t) (m >> 64);
+}
 
-	wsetptr = (list_elem *) malloc( size + sizeof(list_elem ) );
-	if( wsetptr == NULL )
-		return NULL;
+/**
+ * Connect the elements with index multiple of stride in the slots first to
+ * last-1 (slot i is element i * stride) to a single random cycle using
+ * Sattolo's algorithm, or to the reverse of that cycle. The next pointers
+ * hold the permutation while it is generated.
+ * @return slot following first in the forward cycle
+ */
+static long int random_cycle(list_elem *wsetptr, long int first, long int last, uint64_t seed, int reverse){
+	rng_t rng;
+	long int i, succ;
 
-	long num_elements = size/sizeof(list_elem);
-	/* Use pointer array to generate a mapper list */
-	for( i = 0; i < num_elements; i++ )
-		wsetptr[i].next = (void *) i;
-	/* Use Fisher–Yates shuffle algorithm to randomize mapping but consider only every 'stride' element
-	 * starting with element 0.
+	rng_seed( &rng, seed );
+	for( i = first; i < last; i++ )
+		ELEM(wsetptr, i * wset_stride)->next = (void *) i;
+	/* unlike Fisher–Yates j < i, so the permutation is one cycle of all slots
 	 * e.g. stride = 4:
 	 * 0 1 2 3 4 5 6 7 8 9 10 11 12 13
 	 * 0       4       8         12
 	 * 8       12      4         0
 	 */
-	for( i = ((num_elements - 1) / wset_stride) ; i > 0; i-- ) {
-		long j =  (random() % (i + 1));
-		long ii = wset_stride * i;
-		long jj = wset_stride * j;
-		long tmp = (long) wsetptr[ii].next;
-		wsetptr[ii].next = (void *) wsetptr[jj].next;
-		wsetptr[jj].next = (void *) tmp;
+	for( i = last - 1; i > first; i-- ) {
+		long int j = first + rng_below( &rng, i - first );
+		list_elem *tmp = ELEM(wsetptr, i * wset_stride)->next;
+		ELEM(wsetptr, i * wset_stride)->next = ELEM(wsetptr, j * wset_stride)->next;
+		ELEM(wsetptr, j * wset_stride)->next = tmp;
+	}
+	succ = (long) ELEM(wsetptr, first * wset_stride)->next;
+	if( reverse ) {
+		/* follow the cycle, the ids of the elements ahead are still unchanged */
+		long int prev = first, id = succ, next;
+		while( id != first ) {
+			next = (long) ELEM(wsetptr, id * wset_stride)->next;
+			ELEM(wsetptr, id * wset_stride)->next = ELEM(wsetptr, prev * wset_stride);
+			prev = id;
+			id = next;
+		}
+		ELEM(wsetptr, first * wset_stride)->next = ELEM(wsetptr, prev * wset_stride);
+		return succ;
 	}
-	for( i = 0; i < num_elements; i+= wset_stride ) {
-		long id = (long) wsetptr[i].next;
-		wsetptr[i].next = &wsetptr[id];
+	for( i = first; i < last; i++ ) {
+		long int id = (long) ELEM(wsetptr, i * wset_stride)->next;
+		ELEM(wsetptr, i * wset_stride)->next = ELEM(wsetptr, id * wset_stride);
 	}
-
-	return wsetptr;
+	return succ;
 }
 
-long int test_read(long int size, list_elem *wsetptr) {
-	long int access_num;
-	long int num_accesses = NUM_ACCESS_FACTOR * wset_final_size / sizeof( list_elem * );
-	double start, stop;
-	list_elem *lptr;
-	ticks ticks1, ticks2;
+/** arguments of random_cycle for one chunk of a random chain */
+typedef struct {
+	long int first, last;
+	uint64_t seed;
+	long int succ;   /**< result: forward successor of slot first */
+} random_cycle_args;
 
-	if( wsetptr == NULL )
-		return 0;
-	lptr = wsetptr;
+/** chunks of a random chain shared by the generating threads */
+typedef struct {
+	list_elem *wsetptr;
+	random_cycle_args *chunks;
+	long int num_chunks;
+	long int next;   /**< next chunk to be taken by a thread */
+	int reverse;
+} random_chain_work;
 
-	clear_cache();
+static void * random_cycle_thread(void *arg){
+	random_chain_work *work = (random_chain_work *) arg;
+	long int c;
 
-	start = timer();
-	ticks1 = getticks();
+	while( (c = __atomic_fetch_add( &work->next, 1, __ATOMIC_RELAXED )) < work->num_chunks ) {
+		random_cycle_args *a = &work->chunks[c];
+		a->succ = random_cycle( work->wsetptr, a->first, a->last, a->seed, work->reverse );
+	}
+	return NULL;
+}
 
-#ifdef PAPI
-	long long values1[num_hwcntrs];
-	long long values2[num_hwcntrs];
-	PAPI_accum_counters	( values1, num_hwcntrs );
-#endif
-	/* Main loop acessing the data set */
-	for( access_num = 0; access_num < num_accesses; access_num++ )
-		lptr = lptr->next;
-#ifdef PAPI
-	PAPI_accum_counters	( values1, num_hwcntrs );
-#endif
+/**
+ * Build the random chain of init_random, or its exact reverse. Working sets
+ * are split into one chunk per INIT_CHUNK_SIZE Byte, each getting a random
+ * cycle seeded from the seed and its index, so the chain only depends on
+ * the seed and the size. The chunks are generated in parallel by up to one
+ * thread per CPU. The cycles are spliced to a single one by exchanging the
+ * successors of their first elements. The reverse is spliced at the forward
+ * successors of the first elements instead, so both chains visit the same
+ * cycle in opposite directions.
+ * @return wsetptr, NULL if wsetptr is NULL or in case of an error
+ */
+static list_elem * random_chain(list_elem *wsetptr, long int size, int reverse){
+	pthread_t threads[MAX_INIT_THREADS];
+	int started[MAX_INIT_THREADS];
+	random_chain_work work = { wsetptr, NULL, size / INIT_CHUNK_SIZE, 0, reverse };
+	long int num_slots, c, t, num_init_threads;
+	uint64_t seed = random_seed ^ ((uint64_t) size * 0x9e3779b97f4a7c15ULL);
 
-	ticks2 = getticks();
-	stop = timer();
-	double etime = stop - start;
+	if( wsetptr == NULL )
+		return NULL;
 
-#ifdef PAPI
-	fprintf( logfile, "%12.ld %10.6lf %16.2lf %8.1lf", size, etime, num_accesses / etime, (double)(ticks2 - ticks1) / num_accesses );
-	int ii;
-	for( ii = 0; ii < num_hwcntrs; ii++) {
-		fprintf(logfile, "\t%lld", values1[ii] );
+	num_slots = (size / elem_size - 1) / wset_stride + 1;
+	if( work.num_chunks <= 1 ) {
+		random_cycle( wsetptr, 0, num_slots, seed, reverse );
+		return wsetptr;
 	}
-	fprintf( logfile, "\n" );
-#else
-	fprintf( logfile, "%12.ld %10.6lf %16.2lf %8.1lf\n", size, etime, num_accesses / etime, (double)(ticks2 - ticks1) / num_accesses );
-#endif
-	fflush(logfile);
-      
-	return (long) lptr;
+	work.chunks = (random_cycle_args *) malloc( work.num_chunks * sizeof(random_cycle_args) );
+	if( work.chunks == NULL ) {
+		fprintf(stderr, "ERROR: Allocation of %ld random chain chunks failed.\n", work.num_chunks);
+		return NULL;
+	}
+	for( c = 0; c < work.num_chunks; c++ ) {
+		work.chunks[c].first = c * num_slots / work.num_chunks;
+		work.chunks[c].last = (c + 1) * num_slots / work.num_chunks;
+		work.chunks[c].seed = seed + c;
+	}
+
+	num_init_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if( num_init_threads > work.num_chunks )
+		num_init_threads = work.num_chunks;
+	if( num_init_threads > MAX_INIT_THREADS )
+		num_init_threads = MAX_INIT_THREADS;
+	for( t = 1; t < num_init_threads; t++ )
+		started[t] = (pthread_create( &threads[t], NULL, random_cycle_thread, &work ) == 0);
+	random_cycle_thread( &work );
+	for( t = 1; t < num_init_threads; t++ ) {
+		if( started[t] )
+			pthread_join( threads[t], NULL );
+	}
+	if( !reverse ) {
+		for( c = 1; c < work.num_chunks; c++ ) {
+			list_elem *a = ELEM(wsetptr, 0);
+			list_elem *b = ELEM(wsetptr, work.chunks[c].first * wset_stride);
+			list_elem *tmp = a->next;
+			a->next = b->next;
+			b->next = tmp;
+		}
+	}
+	else {
+		/* forward, the first element of chunk c gets the successor of the
+		 * first one of chunk c-1 and element 0 that of the last chunk, so in
+		 * reverse these successors point to the first elements instead */
+		for( c = 0; c < work.num_chunks; c++ ) {
+			long int to = work.chunks[(c + 1) % work.num_chunks].first;
+			ELEM(wsetptr, work.chunks[c].succ * wset_stride)->next = ELEM(wsetptr, to * wset_stride);
+		}
+	}
+	free( work.chunks );
+	return wsetptr;
 }
 
-void result_head(){
-    fprintf(logfile,"# %10s %10s %16s %8s\n", "size", "etime", "access/sec", "ticks/access");
+/**
+ * Build a chain of 'list_elem'ents in the memory at wsetptr of at least
+ * size size Byte. The list elements are connected in a random round robing
+ * way where only elements with index multiple of stride are connected.
+ * @return wsetptr, NULL if wsetptr is NULL
+ */
+list_elem * init_random(list_elem *wsetptr, long int size){
+	return random_chain( wsetptr, size, 0 );
 }
 
-int main( int argc, char* argv[] ){
+/**
+ * Build the chain of init_random in reverse, so the same random layout is
+ * traversed backwards. The chunks are reversed in parallel while they are
+ * generated.
+ * @return wsetptr, NULL if wsetptr is NULL
+ */
+list_elem * init_inverse_random(list_elem *wsetptr, long int size){
+	return random_chain( wsetptr, size, 1 );
+}
 
-	int i;
-	long size;
-	list_elem *wsetptr;
-	long result = 0;
-	char logfilename[256];
-	snprintf(logfilename, 255, "%s-pad%d.log", argv[0], NPAD);
-	logfile = fopen(logfilename, "w+");
+/**
+ * Element in page p of the page patterns. The line used within the page
+ * rotates, so that the elements spread over all cache sets and the cache
+ * footprint stays one line per page.
+ */
+static inline list_elem * page_elem(list_elem *wsetptr, long int p){
+	long int slot = (elem_size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+	return (list_elem *) ((char *) wsetptr + p * page_stride + (p % (page_stride / slot)) * slot);
+}
 
-	typedef list_elem* (*init_fct_ptr)(long);
-	typedef struct {
-		init_fct_ptr function;
-		char *name;
-		int execute;
-	} init_fct_spec;
+/** @return number of pages of size Byte used by the page patterns, at least one */
+static long int num_pages(long int size){
+	return (size < page_stride) ? 1 : size / page_stride;
+}
 
-	init_fct_spec init_functions[] = {
-		{init_sequential, "sequential", 1},
-		{init_inverse_sequential, "inverse-sequential", 1},
-		{init_random, "random", 1}
-	};
+/**
+ * Build a chain in the memory at wsetptr of at least size size Byte which
+ * touches one element per page_stride Byte in sequential page order.
+ * @return wsetptr, NULL if wsetptr is NULL
+ */
+list_elem * init_page_sequential(list_elem *wsetptr, long int size){
+	long int p, n = num_pages( size );
 
-	const char optstring[] = "hm:M:p:s:";
+	if( wsetptr == NULL )
+		return NULL;
+	for( p = 0; p < n - 1; p++ )
+		page_elem(wsetptr, p)->next = page_elem(wsetptr, p + 1);
+	page_elem(wsetptr, n - 1)->next = page_elem(wsetptr, 0);
 
-	char opt;
-	char pattern[1024];
-	char *ptr;
-	char delimiter[] = ",";
+	return wsetptr;
+}
 
-	while ((opt = getopt(argc, argv, optstring)) != -1) {
-		switch(opt) {
-			case 'm':
-				wset_start_size = atol(optarg);
-				break;
-			case 'M':
-				wset_final_size = atol(optarg);
-				break;
-			case 'p':
-				for(i = 0; i < sizeof(init_functions)/sizeof(init_functions[0]); i++) {
-					init_functions[i].execute = 0;
-				}
-				strcpy(pattern, optarg);
-				ptr = strtok(pattern, delimiter);
-				while(ptr != NULL) {
-					if(strcmp(ptr, "all") == 0) {
-						for(i = 0; i < sizeof(init_functions)/sizeof(init_functions[0]); i++) {
-							init_functions[i].execute = 1;
-						}
-					}
-					else {
-						for(i = 0; i < sizeof(init_functions)/sizeof(init_functions[0]); i++) {
-							if(strcmp(ptr, init_functions[i].name) == 0) {
-								init_functions[i].execute = 1;
-							}
-						}
-					}
-					ptr = strtok(NULL, delimiter);
-				}
-				break;
-			case 's':
-				wset_stride = atol(optarg);
-				break;
-			case 'h':
-			default:
-				fprintf(stderr, "Usage: %s [-m min] [-M max] [-p pattern] [-s stride]\n", argv[0]);
-				fprintf(stderr, "Available memory traversal patterns:\n");
-				for(i = 0; i < sizeof(init_functions)/sizeof(init_functions[0]); i++) {
-					fprintf(stderr, "* %s\n", init_functions[i].name);
-				}
-				exit(1);
-				break;
-		}
-	}
+/**
+ * Random single cycle over n indices generated with Sattolo's algorithm,
+ * entry i is the successor of index i.
+ * @return malloc'ed successor array, NULL in case of an error
+ */
+static long int * random_successors(long int n, uint64_t seed){
+	long int i, *perm;
+	rng_t rng;
 
-	if(wset_start_size < wset_stride) {
-		fprintf(stderr, "ERROR: Stride has to be larger than the minumum size. (stride=%ld, min_size=%ld)\n", wset_stride, wset_start_size);
-		exit(1);
+	perm = (long int *) malloc( n * sizeof(long int) );
+	if( perm == NULL ) {
+		fprintf(stderr, "ERROR: Allocation of %ld Bytes failed.\n", n * (long) sizeof(long int));
+		return NULL;
+	}
+	rng_seed( &rng, seed );
+	for( i = 0; i < n; i++ )
+		perm[i] = i;
+	for( i = n - 1; i > 0; i-- ) {
+		long int j = rng_below( &rng, i );
+		long int tmp = perm[i];
+		perm[i] = perm[j];
+		perm[j] = tmp;
 	}
+	return perm;
+}
 
-#ifdef PAPI
-	int retval;
-	retval = PAPI_library_init(PAPI_VER_CURRENT);
-	if (retval != PAPI_VER_CURRENT) {
-		fprintf(stderr,"PAPI library init error!\n");
+/**
+ * Build a chain in the memory at wsetptr of at least size size Byte which
+ * touches one element per page_stride Byte in random page order, as single
+ * cycle generated with Sattolo's algorithm.
+ * @return wsetptr, NULL if wsetptr is NULL or in case of an error
+ */
+list_elem * init_page_random(list_elem *wsetptr, long int size){
+	long int i, n = num_pages( size );
+	long int *perm;
+
+	if( wsetptr == NULL )
+		return NULL;
+	perm = random_successors( n, random_seed ^ ((uint64_t) size * 0x9e3779b97f4a7c15ULL) );
+	if( perm == NULL )
+		return NULL;
+	for( i = 0; i < n; i++ )
+		page_elem(wsetptr, i)->next = page_elem(wsetptr, perm[i]);
+	free( perm );
+
+	return wsetptr;
+}
+
+/**
+ * Build a chain in the memory at wsetptr of at least size size Byte which
+ * visits the elements with index multiple of wset_stride sequentially within
+ * blocks of page_stride Byte, or of one stride if that is larger, while the
+ * blocks follow each other in random order. Stride prefetchers have to train
+ * again at every block boundary. Working sets smaller than one block are
+ * traversed sequentially.
+ * @return wsetptr, NULL if wsetptr is NULL or in case of an error
+ */
+list_elem * init_page_shuffled(list_elem *wsetptr, long int size){
+	long int stride = elem_size * wset_stride;
+	long int block = (stride > page_stride) ? stride : page_stride;
+	long int per_block = block / stride, n = size / block;
+	long int b, k, *succ;
+	char *base = (char *) wsetptr;
+
+	if( wsetptr == NULL )
+		return NULL;
+	if( n == 0 )
+		return init_sequential( wsetptr, size );
+	succ = random_successors( n, random_seed ^ ((uint64_t) size * 0x9e3779b97f4a7c15ULL) );
+	if( succ == NULL )
+		return NULL;
+	for( b = 0; b < n; b++ ) {
+		for( k = 0; k < per_block - 1; k++ )
+			((list_elem *) (base + b * block + k * stride))->next = (list_elem *) (base + b * block + (k + 1) * stride);
+		((list_elem *) (base + b * block + k * stride))->next = (list_elem *) (base + succ[b] * block);
+	}
+	free( succ );
+
+	return wsetptr;
+}
+
+/**
+ * Memory-map the trace file path of little endian 64 bit offsets or
+ * addresses and determine the range of its entries in one streaming pass.
+ * The mapping stays in the page cache, only the replay window of at most
+ * TRACE_WINDOW entries gets a buffer for its folded offsets.
+ * @return 0 on success, 1 otherwise
+ */
+int open_trace(const char *path){
+	struct stat st;
+	long int i;
+	int fd = open( path, O_RDONLY );
+
+	if( fd < 0 || fstat( fd, &st ) != 0 ) {
+		fprintf(stderr, "ERROR: Could not open trace file '%s': %s\n", path, strerror(errno));
+		return 1;
+	}
+	trace_len = st.st_size / sizeof(uint64_t);
+	if( trace_len == 0 || st.st_size % sizeof(uint64_t) != 0 ) {
+		fprintf(stderr, "ERROR: Trace file '%s' has to hold a non-zero number of 64 bit entries.\n", path);
+		close( fd );
+		return 1;
+	}
+	trace_entries = (const uint64_t *) mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+	close( fd );
+	if( trace_entries == MAP_FAILED ) {
+		fprintf(stderr, "ERROR: Could not map trace file '%s': %s\n", path, strerror(errno));
+		trace_entries = NULL;
+		return 1;
+	}
+	madvise( (void *) trace_entries, st.st_size, MADV_SEQUENTIAL );
+	trace_window = (trace_len < TRACE_WINDOW) ? trace_len : TRACE_WINDOW;
+	if( trace_window < trace_len )
+		fprintf(stderr, "WARNING: Only the first %ld of %ld trace entries are replayed per point.\n", trace_window, trace_len);
+	trace_offsets = (uint32_t *) malloc( trace_window * sizeof(uint32_t) );
+	if( trace_offsets == NULL ) {
+		fprintf(stderr, "ERROR: Could not allocate the offsets of %ld trace entries.\n", trace_window);
+		return 1;
+	}
+	trace_min = trace_max = trace_entries[0];
+	for( i = 1; i < trace_len; i++ ) {
+		if( trace_entries[i] < trace_min )
+			trace_min = trace_entries[i];
+		if( trace_entries[i] > trace_max )
+			trace_max = trace_entries[i];
+	}
+	return 0;
+}
+
+/**
+ * Prepare the working set at wsetptr of size size Byte for the replay of
+ * the trace by chase_trace. Every element points to the start of the
+ * working set, the trace entries supply the offsets from there.
+ * @return wsetptr, NULL if wsetptr is NULL
+ */
+list_elem * init_trace(list_elem *wsetptr, long int size){
+	long int i;
+
+	if( wsetptr == NULL )
+		return NULL;
+	for( i = 0; i < size / elem_size; i++ )
+		ELEM(wsetptr, i)->next = wsetptr;
+
+	return wsetptr;
+}
+
+/** @return distance in Byte between consecutive elements of the pattern */
+long int pattern_spacing(init_fct_ptr init){
+	if( init == init_page_sequential || init == init_page_random )
+		return page_stride;
+	return elem_size * wset_stride;
+}
+
+/***********************************************************************
+ * access kernels
+ ***********************************************************************/
+typedef list_elem* (*chase_fct_ptr)(list_elem *, long int);
+
+/** Follow the pointer chain for num_accesses steps. */
+static list_elem * chase_read(list_elem *lptr, long int num_accesses){
+	long int access_num;
+	for( access_num = 0; access_num < num_accesses; access_num++ )
+		lptr = lptr->next;
+	return lptr;
+}
+
+/**
+ * Follow the pointer chain and store to the pad_words padding words of each
+ * element. Elements without padding get their next pointer written back.
+ */
+static inline __attribute__((always_inline))
+list_elem * chase_write(list_elem *lptr, long int num_accesses, long int pad_words){
+	long int access_num, w;
+	for( access_num = 0; access_num < num_accesses; access_num++ ) {
+		list_elem *next = lptr->next;
+		long *pad = (long *) (lptr + 1);
+#pragma GCC unroll 32
+		for( w = 0; w < pad_words; w++ )
+			pad[w] = access_num;
+		if( pad_words == 0 )
+			*(list_elem * volatile *) &lptr->next = next;
+		lptr = next;
+	}
+	return lptr;
+}
+
+/**
+ * Follow the pointer chain and increment the pad_words padding words of each
+ * element. Elements without padding get their next pointer written back.
+ */
+static inline __attribute__((always_inline))
+list_elem * chase_rmw(list_elem *lptr, long int num_accesses, long int pad_words){
+	long int access_num, w;
+	for( access_num = 0; access_num < num_accesses; access_num++ ) {
+		list_elem *next = lptr->next;
+		long *pad = (long *) (lptr + 1);
+#pragma GCC unroll 32
+		for( w = 0; w < pad_words; w++ )
+			pad[w]++;
+		if( pad_words == 0 )
+			*(list_elem * volatile *) &lptr->next = next;
+		lptr = next;
+	}
+	return lptr;
+}
+
+/* kernels with a compile-time element size, so the padding loop gets unrolled */
+#define CHASE_KERNELS(NBYTES) \
+static list_elem * chase_write_##NBYTES(list_elem *lptr, long int num_accesses){ \
+	return chase_write(lptr, num_accesses, (NBYTES - sizeof(list_elem)) / sizeof(long)); \
+} \
+static list_elem * chase_rmw_##NBYTES(list_elem *lptr, long int num_accesses){ \
+	return chase_rmw(lptr, num_accesses, (NBYTES - sizeof(list_elem)) / sizeof(long)); \
+}
+CHASE_KERNELS(8)
+CHASE_KERNELS(16)
+CHASE_KERNELS(32)
+CHASE_KERNELS(64)
+CHASE_KERNELS(128)
+CHASE_KERNELS(256)
+
+static list_elem * chase_write_any(list_elem *lptr, long int num_accesses){
+	return chase_write(lptr, num_accesses, (elem_size - sizeof(list_elem)) / sizeof(long));
+}
+static list_elem * chase_rmw_any(list_elem *lptr, long int num_accesses){
+	return chase_rmw(lptr, num_accesses, (elem_size - sizeof(list_elem)) / sizeof(long));
+}
+
+/* software prefetch chase: addresses of the chain elements in traversal
+ * order and the position of the next access in it */
+list_elem **prefetch_path = NULL;
+long int prefetch_path_len = 0;
+long int prefetch_pos = 0;
+
+/**
+ * Follow the pointer chain and prefetch the element prefetch_distance
+ * accesses ahead, whose address is taken from prefetch_path.
+ */
+static list_elem * chase_prefetch(list_elem *lptr, long int num_accesses){
+	long int access_num, pos = prefetch_pos;
+	long int ahead = (pos + prefetch_distance) % prefetch_path_len;
+	for( access_num = 0; access_num < num_accesses; access_num++ ) {
+		__builtin_prefetch( prefetch_path[ahead] );
+		lptr = lptr->next;
+		if( ++pos == prefetch_path_len )
+			pos = 0;
+		if( ++ahead == prefetch_path_len )
+			ahead = 0;
+	}
+	prefetch_pos = pos;
+	return lptr;
+}
+
+/**
+ * Replay num_accesses entries of trace_offsets from trace_pos on, starting
+ * over at the end of the window. Each address is the pointer loaded from the
+ * previous element plus the offset, so the accesses are serialized like the
+ * pointer chase while the offsets are read independently as a stream.
+ */
+static list_elem * chase_trace(list_elem *lptr, long int num_accesses){
+	const long int size = elem_size;
+	long int pos = trace_pos;
+
+	while( num_accesses > 0 ) {
+		const uint32_t *offsets = trace_offsets + pos;
+		long int access_num, n = trace_window - pos;
+		if( n > num_accesses )
+			n = num_accesses;
+		for( access_num = 0; access_num < n; access_num++ ) {
+			/* non-temporal, so the stream displaces little of the working set */
+			__builtin_prefetch( offsets + access_num + 256, 0, 0 );
+			lptr = (list_elem *) ((char *) lptr->next + offsets[access_num] * size);
+		}
+		num_accesses -= n;
+		pos += n;
+		if( pos == trace_window )
+			pos = 0;
+	}
+	trace_pos = pos;
+	return lptr;
+}
+
+static const struct {
+	long int elem_size;
+	chase_fct_ptr write;
+	chase_fct_ptr rmw;
+} chase_kernels[] = {
+	{   8, chase_write_8,   chase_rmw_8   },
+	{  16, chase_write_16,  chase_rmw_16  },
+	{  32, chase_write_32,  chase_rmw_32  },
+	{  64, chase_write_64,  chase_rmw_64  },
+	{ 128, chase_write_128, chase_rmw_128 },
+	{ 256, chase_write_256, chase_rmw_256 },
+};
+
+/***********************************************************************
+ * statistics over repeated measurements
+ ***********************************************************************/
+typedef struct {
+	int n;
+	double min;
+	double median;
+	double mean;
+	double stddev;
+	double ci95;        /**< half width of the 95% confidence interval of the mean */
+} stats_t;
+
+static int compare_double(const void *a, const void *b){
+	double x = *(const double *) a, y = *(const double *) b;
+	return (x > y) - (x < y);
+}
+
+/**
+ * Two-sided 95% quantile of Student's t-distribution.
+ */
+static double t95(int df){
+	static const double table[] = { 0., 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+	                                2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093,
+	                                2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+	if( df < 1 )
+		return INFINITY;
+	if( df < sizeof(table)/sizeof(table[0]) )
+		return table[df];
+	return 1.96;
+}
+
+/**
+ * Compute min, median, mean, standard deviation and 95% confidence interval
+ * of the n values.
+ */
+void compute_stats(const double *values, int n, stats_t *stats){
+	double sorted[n];
+	double sum = 0., sum2 = 0.;
+	int i;
+
+	memcpy( sorted, values, n * sizeof(double) );
+	qsort( sorted, n, sizeof(double), compare_double );
+	for( i = 0; i < n; i++ )
+		sum += values[i];
+	stats->n = n;
+	stats->min = sorted[0];
+	stats->median = (n % 2) ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+	stats->mean = sum / n;
+	for( i = 0; i < n; i++ )
+		sum2 += (values[i] - stats->mean) * (values[i] - stats->mean);
+	stats->stddev = (n > 1) ? sqrt( sum2 / (n - 1) ) : 0.;
+	stats->ci95 = (n > 1) ? t95( n - 1 ) * stats->stddev / sqrt( n ) : 0.;
+}
+
+/**
+ * Check whether another measurement is required after n measurements to
+ * reach the targeted confidence interval.
+ */
+int need_repetition(const double *values, int n){
+	stats_t stats;
+	if( n < repetitions )
+		return 1;
+	if( ci_target <= 0. || n >= MAX_REPETITIONS )
+		return 0;
+	compute_stats( values, n, &stats );
+	return n < 2 || 2. * stats.ci95 > ci_target * stats.mean;
+}
+
+/**
+ * Write the statistics columns of a point to the log file if repetitions
+ * are enabled.
+ */
+void log_stats(const stats_t *stats){
+	if( repetitions > 1 || ci_target > 0. )
+		fprintf( logfile, " %4d %10.3lf %10.3lf %10.3lf %10.3lf", stats->n, stats->min, stats->mean, stats->stddev, stats->ci95 );
+}
+
+/***********************************************************************
+ * hardware performance counters
+ ***********************************************************************/
+#define CACHE_EVENT(cache, op, result) \
+	((PERF_COUNT_HW_CACHE_##cache) | (PERF_COUNT_HW_CACHE_OP_##op << 8) | (PERF_COUNT_HW_CACHE_RESULT_##result << 16))
+
+/** named event for perf_event_open */
+typedef struct {
+	const char *name;
+	uint32_t type;
+	uint64_t config;
+} perf_event_spec;
+
+const perf_event_spec perf_event_names[] = {
+	{"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+	{"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+	{"l1d-loads", PERF_TYPE_HW_CACHE, CACHE_EVENT(L1D, READ, ACCESS)},
+	{"l1d-misses", PERF_TYPE_HW_CACHE, CACHE_EVENT(L1D, READ, MISS)},
+	{"llc-loads", PERF_TYPE_HW_CACHE, CACHE_EVENT(LL, READ, ACCESS)},
+	{"llc-misses", PERF_TYPE_HW_CACHE, CACHE_EVENT(LL, READ, MISS)},
+	{"dtlb-loads", PERF_TYPE_HW_CACHE, CACHE_EVENT(DTLB, READ, ACCESS)},
+	{"dtlb-misses", PERF_TYPE_HW_CACHE, CACHE_EVENT(DTLB, READ, MISS)},
+	{"page-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+	{"task-clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK}
+};
+
+/* events selected with --events and their file descriptors, every
+ * EVENTS_PER_GROUP events form a group led by the first of them */
+perf_event_spec events[MAX_EVENTS];
+int event_fds[MAX_EVENTS];
+int num_events = 0;
+
+/**
+ * Parse the comma separated list of event names or raw events given as
+ * r<hex config> into events.
+ * @return number of events, -1 in case of an unknown event
+ */
+int parse_events(const char *list){
+	char buf[1024];
+	char *ptr;
+	int i;
+
+	strncpy(buf, list, sizeof(buf) - 1);
+	buf[sizeof(buf) - 1] = '\0';
+	num_events = 0;
+	for(ptr = strtok(buf, ","); ptr != NULL && num_events < MAX_EVENTS; ptr = strtok(NULL, ",")) {
+		perf_event_spec *ev = &events[num_events];
+		char *end;
+		for(i = 0; i < sizeof(perf_event_names)/sizeof(perf_event_names[0]); i++) {
+			if(strcmp(ptr, perf_event_names[i].name) == 0)
+				break;
+		}
+		if(i < sizeof(perf_event_names)/sizeof(perf_event_names[0])) {
+			*ev = perf_event_names[i];
+		}
+		else {
+			ev->name = strdup(ptr);
+			ev->type = PERF_TYPE_RAW;
+			ev->config = strtoull(ptr + 1, &end, 16);
+			if(ptr[0] != 'r' || end == ptr + 1 || *end != '\0') {
+				fprintf(stderr, "ERROR: Unknown event '%s'.\n", ptr);
+				return -1;
+			}
+		}
+		num_events++;
+	}
+	return num_events;
+}
+
+/**
+ * Open the selected events for the calling thread grouped by
+ * EVENTS_PER_GROUP. The events count from now on and are read around each
+ * measurement.
+ * @return 0 on success, 1 otherwise
+ */
+int open_events(){
+	struct perf_event_attr attr;
+	int e;
+
+	for( e = 0; e < num_events; e++ ) {
+		int leader = (e % EVENTS_PER_GROUP == 0);
+		memset( &attr, 0, sizeof(attr) );
+		attr.size = sizeof(attr);
+		attr.type = events[e].type;
+		attr.config = events[e].config;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		event_fds[e] = syscall( SYS_perf_event_open, &attr, 0, -1,
+		                        leader ? -1 : event_fds[e - e % EVENTS_PER_GROUP], 0 );
+		if( event_fds[e] < 0 ) {
+			fprintf(stderr, "ERROR: Could not open event '%s': %s\n", events[e].name, strerror(errno));
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/** counter values of all events at one point in time */
+typedef struct {
+	uint64_t count[MAX_EVENTS];
+	uint64_t enabled[MAX_EVENTS]; /**< time the group was enabled, at the leader's index */
+	uint64_t running[MAX_EVENTS]; /**< time the group was counting, at the leader's index */
+} event_snapshot;
+
+/** Read the counters of all event groups. */
+void events_read(event_snapshot *snap){
+	uint64_t buf[3 + EVENTS_PER_GROUP];
+	int e, i;
+
+	for( e = 0; e < num_events; e += EVENTS_PER_GROUP ) {
+		/* nr, time_enabled, time_running, values */
+		memset( buf, 0, sizeof(buf) );
+		if( read( event_fds[e], buf, sizeof(buf) ) < (ssize_t) (3 * sizeof(uint64_t)) )
+			buf[0] = 0;
+		snap->enabled[e] = buf[1];
+		snap->running[e] = buf[2];
+		for( i = 0; i < EVENTS_PER_GROUP && e + i < num_events; i++ )
+			snap->count[e + i] = (i < buf[0]) ? buf[3 + i] : 0;
+	}
+}
+
+/**
+ * Add the counts between two snapshots to values. Counts of groups which
+ * were multiplexed are scaled to the enabled time, groups which did not run
+ * give NAN.
+ */
+void events_add(const event_snapshot *before, const event_snapshot *after, double *values){
+	int e;
+
+	for( e = 0; e < num_events; e++ ) {
+		int leader = e - e % EVENTS_PER_GROUP;
+		uint64_t enabled = after->enabled[leader] - before->enabled[leader];
+		uint64_t running = after->running[leader] - before->running[leader];
+		if( running == 0 )
+			values[e] = NAN;
+		else
+			values[e] += (double) (after->count[e] - before->count[e]) * enabled / running;
+	}
+}
+
+/** Write the names of the selected events as column headers. */
+void events_head(){
+	int e;
+	for( e = 0; e < num_events; e++ ) {
+		char name[64];
+		snprintf( name, sizeof(name), "%s/access", events[e].name );
+		fprintf( logfile, " %14s", name );
+	}
+}
+
+/***********************************************************************
+ * measured points of the current sweep
+ ***********************************************************************/
+typedef struct {
+	long int size;      /**< working set size */
+	double ticks;       /**< ticks per access */
+	double ns;          /**< nanoseconds per access */
+} sweep_point;
+
+sweep_point *sweep_points = NULL;
+long int num_sweep_points = 0;
+long int max_sweep_points = 0;
+
+/**
+ * Append a measured point to sweep_points.
+ */
+void record_point(long int size, double ticks_per_access, double ns_per_access){
+	if( num_sweep_points == max_sweep_points ) {
+		long int max = max_sweep_points ? 2 * max_sweep_points : 1024;
+		sweep_point *points = realloc( sweep_points, max * sizeof(sweep_point) );
+		if( points == NULL )
+			return;
+		sweep_points = points;
+		max_sweep_points = max;
+	}
+	sweep_points[num_sweep_points].size = size;
+	sweep_points[num_sweep_points].ticks = ticks_per_access;
+	sweep_points[num_sweep_points].ns = ns_per_access;
+	num_sweep_points++;
+}
+
+int compare_sweep_point(const void *a, const void *b){
+	long int x = ((const sweep_point *) a)->size, y = ((const sweep_point *) b)->size;
+	return (x > y) - (x < y);
+}
+
+/***********************************************************************
+ * structured output
+ ***********************************************************************/
+typedef enum { FORMAT_LOG, FORMAT_CSV, FORMAT_JSON } format_t;
+const char *format_names[] = { "log", "csv", "json" };
+format_t output_format = FORMAT_LOG;
+
+/* structured results, NULL for the log format */
+FILE *outfile = NULL;
+long int num_rows = 0;
+
+/* test, pattern and kernel of the running sweep, written to every row */
+const char *row_test = "latency";
+const char *row_pattern = "";
+const char *row_kernel = "";
+
+/** one measured point, values which do not apply are NAN */
+typedef struct {
+	long int size;
+	double etime;
+	double ticks_per_access;
+	double ns_per_access;
+	double ticks_per_byte;
+	double gb_per_sec;
+	const stats_t *stats;  /**< statistics of the ticks per access or GB/s, NULL for a single measurement */
+	const double *events;  /**< per access counts of the events, NULL without events */
+	int mem_node, cpu_node; /**< NUMA matrix only, -1 otherwise */
+} result_row;
+
+/** description of the machine written to the header of every output */
+typedef struct {
+	char hostname[256];
+	char cpu_model[256];
+	char governor[64];
+	char thp[64];
+	char kernel[256];
+	char numa_nodes[1024];
+} machine_info;
+machine_info machine;
+
+int read_sysfs(const char *path, char *buf, int len);
+int parse_id_list(const char *list, int *ids, int max_ids);
+
+/** Copy src to dst of size len without the trailing newline. */
+static void copy_line(char *dst, const char *src, size_t len){
+	size_t n = strcspn(src, "\n");
+	if( n >= len )
+		n = len - 1;
+	memcpy(dst, src, n);
+	dst[n] = '\0';
+}
+
+/**
+ * Gather CPU model, frequency governor, transparent huge page setting,
+ * kernel and the CPUs of the NUMA nodes from /proc and sysfs.
+ */
+void collect_machine_info(){
+	char buf[4096], path[256];
+	struct utsname uts;
+	FILE *fp;
+	int nodes[MAX_NUMA_NODES];
+	int num_nodes, n;
+	char *sel;
+
+	strcpy(machine.cpu_model, "unknown");
+	fp = fopen("/proc/cpuinfo", "r");
+	if( fp != NULL ) {
+		while( fgets(buf, sizeof(buf), fp) != NULL ) {
+			char *colon = strchr(buf, ':');
+			if( strncmp(buf, "model name", 10) == 0 && colon != NULL ) {
+				copy_line(machine.cpu_model, colon + 2, sizeof(machine.cpu_model));
+				break;
+			}
+		}
+		fclose(fp);
+	}
+	if( read_sysfs("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor", buf, sizeof(buf)) == 0 )
+		copy_line(machine.governor, buf, sizeof(machine.governor));
+	else
+		strcpy(machine.governor, "unknown");
+	/* the active setting is marked like "always [madvise] never" */
+	strcpy(machine.thp, "unknown");
+	if( read_sysfs("/sys/kernel/mm/transparent_hugepage/enabled", buf, sizeof(buf)) == 0 && (sel = strchr(buf, '[')) != NULL ) {
+		copy_line(machine.thp, sel + 1, sizeof(machine.thp));
+		machine.thp[strcspn(machine.thp, "]")] = '\0';
+	}
+	if( uname(&uts) == 0 ) {
+		snprintf(machine.kernel, sizeof(machine.kernel), "%s %s %s", uts.sysname, uts.release, uts.machine);
+		snprintf(machine.hostname, sizeof(machine.hostname), "%s", uts.nodename);
+	}
+	else {
+		strcpy(machine.kernel, "unknown");
+		strcpy(machine.hostname, "unknown");
+	}
+	/* node:cpulist for every online node */
+	if( read_sysfs("/sys/devices/system/node/online", buf, sizeof(buf)) != 0 )
+		strcpy(buf, "0");
+	num_nodes = parse_id_list(buf, nodes, MAX_NUMA_NODES);
+	machine.numa_nodes[0] = '\0';
+	for( n = 0; n < num_nodes; n++ ) {
+		size_t len = strlen(machine.numa_nodes);
+		snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", nodes[n]);
+		if( read_sysfs(path, buf, sizeof(buf)) != 0 )
+			buf[0] = '\0';
+		buf[strcspn(buf, "\n")] = '\0';
+		snprintf(machine.numa_nodes + len, sizeof(machine.numa_nodes) - len, "%s%d:%s", n ? " " : "", nodes[n], buf);
+	}
+}
+
+/** Write a string as JSON string literal. */
+static void json_string(FILE *fp, const char *str){
+	fputc('"', fp);
+	for( ; *str != '\0'; str++ ) {
+		if( *str == '"' || *str == '\\' )
+			fprintf(fp, "\\%c", *str);
+		else if( (unsigned char) *str < 0x20 )
+			fprintf(fp, "\\u%04x", *str);
+		else
+			fputc(*str, fp);
+	}
+	fputc('"', fp);
+}
+
+/** Write a number, NAN as empty CSV field or JSON null. */
+static void output_number(double value){
+	if( isnan(value) || isinf(value) )
+		fprintf(outfile, "%s", output_format == FORMAT_JSON ? "null" : "");
+	else if( value == (long) value )
+		fprintf(outfile, "%ld", (long) value);
+	else
+		fprintf(outfile, "%.9g", value);
+}
+
+/** Write one metadata entry as CSV comment or JSON member. */
+static void output_meta(const char *key, const char *value, int first){
+	if( output_format == FORMAT_CSV ) {
+		fprintf(outfile, "# %s: %s\n", key, value);
+	}
+	else {
+		fprintf(outfile, "%s\n    ", first ? "" : ",");
+		json_string(outfile, key);
+		fprintf(outfile, ": ");
+		json_string(outfile, value);
+	}
+}
+
+const char *row_columns[] = { "test", "pattern", "kernel", "elem_size", "stride", "chains", "threads",
+                              "mem_node", "cpu_node", "size", "etime", "ticks_per_access", "ns_per_access",
+                              "ticks_per_byte", "gb_per_sec", "reps", "min", "mean", "stddev", "ci95" };
+
+/**
+ * Write the metadata of the run and, for CSV, the column names to outfile.
+ * The statistics columns refer to ticks_per_access for latency and to
+ * gb_per_sec for bandwidth rows.
+ */
+void output_begin(int argc, char *argv[]){
+	char buf[4096];
+	time_t now = time(NULL);
+	int i;
+
+	if( outfile == NULL )
+		return;
+	if( output_format == FORMAT_JSON )
+		fprintf(outfile, "{\n  \"metadata\": {");
+	buf[0] = '\0';
+	for( i = 0; i < argc; i++ )
+		snprintf(buf + strlen(buf), sizeof(buf) - strlen(buf), "%s%s", i ? " " : "", argv[i]);
+	output_meta("command", buf, 1);
+	copy_line(buf, asctime(localtime(&now)), sizeof(buf));
+	output_meta("date", buf, 0);
+	output_meta("hostname", machine.hostname, 0);
+	output_meta("cpu_model", machine.cpu_model, 0);
+	output_meta("governor", machine.governor, 0);
+	output_meta("thp", machine.thp, 0);
+	output_meta("kernel", machine.kernel, 0);
+	output_meta("numa_nodes", machine.numa_nodes, 0);
+	snprintf(buf, sizeof(buf), "%llu", (unsigned long long) random_seed);
+	output_meta("seed", buf, 0);
+	snprintf(buf, sizeof(buf), "%.3lf", tsc_ghz);
+	output_meta("tsc_ghz", buf, 0);
+	output_meta("allocation", alloc_policy_names[alloc_policy], 0);
+	output_meta("flush", flush_mode_names[flush_mode], 0);
+	snprintf(buf, sizeof(buf), "%lf", point_duration);
+	output_meta("time_per_point", buf, 0);
+	if( output_format == FORMAT_JSON ) {
+		fprintf(outfile, "\n  },\n  \"results\": [");
+	}
+	else {
+		for( i = 0; i < sizeof(row_columns)/sizeof(row_columns[0]); i++ )
+			fprintf(outfile, "%s%s", i ? "," : "", row_columns[i]);
+		for( i = 0; i < num_events; i++ )
+			fprintf(outfile, ",%s_per_access", events[i].name);
+		fprintf(outfile, "\n");
+	}
+	fflush(outfile);
+}
+
+/** Write one measured point to outfile. */
+void output_row(const result_row *row){
+	const stats_t *st = row->stats;
+	double values[] = { elem_size, wset_stride, num_chains, num_threads, row->mem_node, row->cpu_node, row->size,
+	                    row->etime, row->ticks_per_access, row->ns_per_access, row->ticks_per_byte, row->gb_per_sec,
+	                    st ? st->n : 1, st ? st->min : NAN, st ? st->mean : NAN, st ? st->stddev : NAN, st ? st->ci95 : NAN };
+	const char *names[] = { row_test, row_pattern, row_kernel };
+	int i;
+
+	if( outfile == NULL )
+		return;
+	if( output_format == FORMAT_JSON ) {
+		fprintf(outfile, "%s\n    {", num_rows ? "," : "");
+		for( i = 0; i < 3; i++ ) {
+			fprintf(outfile, "%s\"%s\": ", i ? ", " : "", row_columns[i]);
+			json_string(outfile, names[i]);
+		}
+		for( i = 0; i < sizeof(values)/sizeof(values[0]); i++ ) {
+			fprintf(outfile, ", \"%s\": ", row_columns[3 + i]);
+			output_number(values[i]);
+		}
+		for( i = 0; i < num_events; i++ ) {
+			fprintf(outfile, ", \"%s_per_access\": ", events[i].name);
+			output_number(row->events ? row->events[i] : NAN);
+		}
+		fprintf(outfile, "}");
+	}
+	else {
+		fprintf(outfile, "%s,%s,%s", names[0], names[1], names[2]);
+		for( i = 0; i < sizeof(values)/sizeof(values[0]); i++ ) {
+			fprintf(outfile, ",");
+			output_number(values[i]);
+		}
+		for( i = 0; i < num_events; i++ ) {
+			fprintf(outfile, ",");
+			output_number(row->events ? row->events[i] : NAN);
+		}
+		fprintf(outfile, "\n");
+	}
+	num_rows++;
+	fflush(outfile);
+}
+
+/** Finish the structured output, registered with atexit. */
+void output_end(){
+	if( outfile == NULL )
+		return;
+	if( output_format == FORMAT_JSON )
+		fprintf(outfile, "\n  ]\n}\n");
+	fclose(outfile);
+	outfile = NULL;
+}
+
+/***********************************************************************
+ * baseline comparison
+ ***********************************************************************/
+/* relative change of a point which counts as regression */
+double regression_threshold = 0.05;
+
+/** point of a baseline written with --format csv */
+typedef struct {
+	char key[256];           /**< test, pattern, kernel and the numeric columns up to size */
+	double ticks_per_access;
+	double gb_per_sec;
+	int reps;
+	double mean, stddev;     /**< of ticks_per_access or gb_per_sec */
+	int matched;
+} baseline_point;
+
+const char *baseline_file = NULL;
+baseline_point *baseline = NULL;
+long int num_baseline = 0;
+long int num_compared = 0;
+long int num_regressions = 0;
+
+/** number of leading columns identifying a point, test to size */
+#define KEY_COLUMNS 10
+
+/** Split a CSV line in place into at most max fields. @return number of fields */
+static int split_csv(char *line, char **fields, int max){
+	int n = 0;
+	line[strcspn(line, "\r\n")] = '\0';
+	while( n < max ) {
+		fields[n++] = line;
+		line = strchr(line, ',');
+		if( line == NULL )
+			break;
+		*line++ = '\0';
+	}
+	return n;
+}
+
+/** Build the key of a point from its test, pattern, kernel and numeric key columns. */
+static void point_key(char *key, size_t len, const char *test, const char *pattern, const char *kernel, const long *ids){
+	snprintf(key, len, "%s,%s,%s,%ld,%ld,%ld,%ld,%ld,%ld,%ld", test, pattern, kernel,
+	         ids[0], ids[1], ids[2], ids[3], ids[4], ids[5], ids[6]);
+}
+
+/**
+ * Read the baseline written by an earlier run with --format csv. Columns
+ * are looked up by name, so baselines with other events can be compared.
+ * @return 0 on success, 1 otherwise
+ */
+int load_baseline(const char *path){
+	const char *wanted[] = { "ticks_per_access", "gb_per_sec", "reps", "mean", "stddev" };
+	int col[5];
+	char line[4096];
+	char *fields[256];
+	int num_fields, i, j, have_header = 0;
+	long int max = 0;
+	FILE *fp = fopen(path, "r");
+
+	if( fp == NULL ) {
+		fprintf(stderr, "ERROR: Could not open baseline '%s': %s\n", path, strerror(errno));
+		return 1;
+	}
+	while( fgets(line, sizeof(line), fp) != NULL ) {
+		if( line[0] == '#' || line[0] == '\n' )
+			continue;
+		num_fields = split_csv(line, fields, 256);
+		if( !have_header ) {
+			for( j = 0; j < 5; j++ ) {
+				for( i = 0; i < num_fields && strcmp(fields[i], wanted[j]) != 0; i++ )
+					;
+				if( i == num_fields || num_fields < KEY_COLUMNS ) {
+					fprintf(stderr, "ERROR: Baseline '%s' is no CSV output of cache-analyse.\n", path);
+					fclose(fp);
+					return 1;
+				}
+				col[j] = i;
+			}
+			have_header = 1;
+			continue;
+		}
+		if( num_fields < KEY_COLUMNS )
+			continue;
+		if( num_baseline == max ) {
+			max = max ? 2 * max : 1024;
+			baseline = realloc( baseline, max * sizeof(baseline_point) );
+			if( baseline == NULL ) {
+				fclose(fp);
+				return 1;
+			}
+		}
+		baseline_point *b = &baseline[num_baseline++];
+		long ids[KEY_COLUMNS - 3];
+		double values[5];
+		for( i = 0; i < KEY_COLUMNS - 3; i++ )
+			ids[i] = atol( fields[3 + i] );
+		point_key( b->key, sizeof(b->key), fields[0], fields[1], fields[2], ids );
+		for( j = 0; j < 5; j++ )
+			values[j] = (col[j] < num_fields && fields[col[j]][0] != '\0') ? atof( fields[col[j]] ) : NAN;
+		b->ticks_per_access = values[0];
+		b->gb_per_sec = values[1];
+		b->reps = isnan(values[2]) ? 1 : (int) values[2];
+		b->mean = values[3];
+		b->stddev = values[4];
+		b->matched = 0;
+	}
+	fclose(fp);
+	baseline_file = path;
+	return 0;
+}
+
+/**
+ * Welch's t-test of the means of two repeated measurements.
+ * @return whether the means differ at the 95% level
+ */
+static int significant(double mean1, double stddev1, int n1, double mean2, double stddev2, int n2){
+	double v1 = stddev1 * stddev1 / n1, v2 = stddev2 * stddev2 / n2;
+	double df;
+
+	if( v1 + v2 == 0. )
+		return mean1 != mean2;
+	df = (v1 + v2) * (v1 + v2) / (v1 * v1 / (n1 - 1) + v2 * v2 / (n2 - 1));
+	return fabs(mean1 - mean2) / sqrt(v1 + v2) > t95( df < 1. ? 1 : (int) df );
+}
+
+/**
+ * Compare one metric of a point with the baseline. It regressed if it is
+ * worse by more than regression_threshold and, where both sides were
+ * repeated, the difference is significant.
+ * @return 1 if the metric regressed
+ */
+static int check_metric(const char *name, double base, double value, int higher_is_worse,
+                        const baseline_point *b, const stats_t *stats, const char *key){
+	double change;
+
+	if( isnan(base) || isnan(value) || base == 0. )
+		return 0;
+	change = (value - base) / base;
+	if( (higher_is_worse ? change : -change) <= regression_threshold )
+		return 0;
+	if( stats != NULL && b->reps > 1 && !isnan(b->mean) && !isnan(b->stddev)
+	    && !significant( b->mean, b->stddev, b->reps, stats->mean, stats->stddev, stats->n ) )
+		return 0;
+	fprintf( logfile, "# Regression %s: %s %.3lf -> %.3lf (%+.1lf%%)\n", key, name, base, value, change * 100. );
+	fprintf( stderr, "Regression %s: %s %.3lf -> %.3lf (%+.1lf%%)\n", key, name, base, value, change * 100. );
+	return 1;
+}
+
+/** Look up a measured point in the baseline and check it for regressions. */
+void compare_row(const result_row *row){
+	char key[256];
+	long ids[KEY_COLUMNS - 3] = { elem_size, wset_stride, num_chains, num_threads, row->mem_node, row->cpu_node, row->size };
+	long int i;
+	int worse;
+
+	if( baseline_file == NULL )
+		return;
+	point_key( key, sizeof(key), row_test, row_pattern, row_kernel, ids );
+	for( i = 0; i < num_baseline && strcmp(baseline[i].key, key) != 0; i++ )
+		;
+	if( i == num_baseline )
+		return;
+	baseline[i].matched = 1;
+	num_compared++;
+	worse = check_metric( "ticks/access", baseline[i].ticks_per_access, row->ticks_per_access, 1, &baseline[i], row->stats, key );
+	worse |= check_metric( "GB/s", baseline[i].gb_per_sec, row->gb_per_sec, 0, &baseline[i], row->stats, key );
+	num_regressions += worse;
+}
+
+/**
+ * Summarize the comparison with the baseline in the log and on stderr.
+ * @return exit code, 2 if any point regressed
+ */
+int compare_summary(){
+	long int i, missing = 0;
+
+	if( baseline_file == NULL )
+		return 0;
+	for( i = 0; i < num_baseline; i++ )
+		missing += !baseline[i].matched;
+	fprintf( logfile, "# Baseline %s: %ld points compared, %ld regressions, %ld baseline points not measured\n",
+	         baseline_file, num_compared, num_regressions, missing );
+	fprintf( stderr, "Baseline %s: %ld points compared, %ld regressions, %ld baseline points not measured\n",
+	         baseline_file, num_compared, num_regressions, missing );
+	fflush( logfile );
+	return num_regressions ? 2 : 0;
+}
+
+/** Write a measured point to the structured output and compare it with the baseline. */
+void report_row(const result_row *row){
+	output_row( row );
+	compare_row( row );
+}
+
+/**
+ * Calibrate the time stamp counter frequency against the clock by busy
+ * waiting for TSC_CALIBRATION_TIME seconds.
+ */
+void calibrate_tsc(){
+	double start, stop;
+	ticks ticks1, ticks2;
+
+	start = timer();
+	ticks1 = tsc_begin();
+	do {
+		stop = timer();
+	} while( stop - start < TSC_CALIBRATION_TIME );
+	ticks2 = tsc_end();
+	stop = timer();
+	tsc_ghz = (double) (ticks2 - ticks1) / (stop - start) / 1e9;
+}
+
+/**
+ * Measure the fixed cost of a timed chase, i.e. reading the timers, calling
+ * the kernel and setting up its loop, as the minimum over OVERHEAD_SAMPLES
+ * runs without accesses.
+ */
+void measure_overhead(list_elem *lptr, chase_fct_ptr chase, double *ovh_ticks, double *ovh_sec){
+	double start, stop;
+	ticks ticks1, ticks2;
+	int i;
+
+	*ovh_ticks = *ovh_sec = INFINITY;
+	for( i = 0; i < OVERHEAD_SAMPLES; i++ ) {
+		start = timer();
+		ticks1 = tsc_begin();
+		lptr = chase( lptr, 0 );
+		ticks2 = tsc_end();
+		stop = timer();
+		if( ticks2 - ticks1 < *ovh_ticks )
+			*ovh_ticks = ticks2 - ticks1;
+		if( stop - start < *ovh_sec )
+			*ovh_sec = stop - start;
+	}
+	calibration_sink = (long) lptr;
+}
+
+/**
+ * Determine the number of accesses of the chase kernel which take about
+ * point_duration seconds. The kernel is run with growing counts until a
+ * run takes CALIBRATION_FRACTION of that time and the count is scaled up.
+ * The chase starts at *lptr, which is advanced along with it, so that
+ * kernels tracking their position in the chain stay in step.
+ * @return number of accesses, at least min_accesses
+ */
+long int calibrate_accesses(list_elem **lptr, chase_fct_ptr chase, long int min_accesses){
+	long int num_accesses = 1024;
+	double start, etime;
+
+	while( 1 ) {
+		start = timer();
+		*lptr = chase( *lptr, num_accesses );
+		etime = timer() - start;
+		if( etime >= CALIBRATION_FRACTION * point_duration )
+			break;
+		num_accesses *= 4;
+	}
+	num_accesses = (long int) (num_accesses * point_duration / etime);
+	return num_accesses > min_accesses ? num_accesses : min_accesses;
+}
+
+/**
+ * Time the chase kernel on the working set for about point_duration seconds
+ * and write one result line to the log file. Unless flush_mode is warm, one
+ * traversal of the chain is timed right after the caches were cleared and
+ * written as cold latency, the repetitions then measure the steady state.
+ * @return final list pointer as long to keep the traversal alive
+ */
+static long int test_chase(long int size, list_elem *wsetptr, chase_fct_ptr chase) {
+	long int num_accesses;
+	double start, stop;
+	list_elem *lptr;
+	ticks ticks1, ticks2;
+	double etimes[MAX_REPETITIONS], tick_counts[MAX_REPETITIONS];
+	double ovh_ticks, ovh_sec;
+	double cold_ticks = NAN;
+	double event_counts[MAX_EVENTS] = { 0. };
+	event_snapshot events_before, events_after;
+	stats_t etime_stats, tick_stats;
+	int rep, e;
+
+	if( wsetptr == NULL )
+		return 0;
+	lptr = wsetptr;
+	num_accesses = calibrate_accesses( &lptr, chase, NUM_ACCESS_FACTOR * chain_length );
+	measure_overhead( lptr, chase, &ovh_ticks, &ovh_sec );
+
+#ifdef PAPI
+	long long values1[num_hwcntrs];
+	long long values2[num_hwcntrs];
+#endif
+	/* calibration has warmed the caches, so the cold latency is only seen
+	 * by one traversal timed right after clearing them */
+	if( flush_mode == FLUSH_WARM ) {
+		lptr = chase( lptr, chain_length );
+	}
+	else {
+		clear_cache( wsetptr, size );
+		ticks1 = tsc_begin();
+		lptr = chase( lptr, chain_length );
+		ticks2 = tsc_end();
+		cold_ticks = (ticks2 - ticks1 - ovh_ticks) / chain_length;
+	}
+	for( rep = 0; rep == 0 || need_repetition( tick_counts, rep ); rep++ ) {
+
+		events_read( &events_before );
+		start = timer();
+		ticks1 = tsc_begin();
+
+#ifdef PAPI
+		PAPI_accum_counters	( values1, num_hwcntrs );
+#endif
+		/* Main loop acessing the data set */
+		lptr = chase( lptr, num_accesses );
+#ifdef PAPI
+		PAPI_accum_counters	( values1, num_hwcntrs );
+#endif
+
+		ticks2 = tsc_end();
+		stop = timer();
+		events_read( &events_after );
+		events_add( &events_before, &events_after, event_counts );
+		etimes[rep] = stop - start - ovh_sec;
+		tick_counts[rep] = (ticks2 - ticks1 - ovh_ticks) / num_accesses;
+	}
+	compute_stats( etimes, rep, &etime_stats );
+	compute_stats( tick_counts, rep, &tick_stats );
+	double etime = etime_stats.median;
+
+	fprintf( logfile, "%12.ld %10.6lf %16.2lf %8.1lf %8.2lf", size, etime, num_accesses / etime,
+	         tick_stats.median, tick_stats.median / tsc_ghz );
+	log_stats( &tick_stats );
+	if( flush_mode != FLUSH_WARM )
+		fprintf( logfile, " %8.1lf", cold_ticks );
+	for( e = 0; e < num_events; e++ ) {
+		event_counts[e] /= (double) num_accesses * rep;
+		fprintf( logfile, " %14.4lf", event_counts[e] );
+	}
+#ifdef PAPI
+	int ii;
+	for( ii = 0; ii < num_hwcntrs; ii++) {
+		fprintf(logfile, "\t%lld", values1[ii] );
+	}
+#endif
+	fprintf( logfile, "\n" );
+	fflush(logfile);
+	record_point( size, tick_stats.median, tick_stats.median / tsc_ghz );
+	result_row row = { size, etime, tick_stats.median, tick_stats.median / tsc_ghz, NAN, NAN,
+	                   (rep > 1) ? &tick_stats : NULL, num_events ? event_counts : NULL, -1, -1 };
+	report_row( &row );
+
+	return (long) lptr;
+}
+
+/** @return read chase kernel */
+chase_fct_ptr read_kernel(){
+	return chase_read;
+}
+
+/** @return write chase kernel for the current element size */
+chase_fct_ptr write_kernel(){
+	int i;
+	for( i = 0; i < sizeof(chase_kernels)/sizeof(chase_kernels[0]); i++ )
+		if( chase_kernels[i].elem_size == elem_size )
+			return chase_kernels[i].write;
+	return chase_write_any;
+}
+
+/** @return read-modify-write chase kernel for the current element size */
+chase_fct_ptr rmw_kernel(){
+	int i;
+	for( i = 0; i < sizeof(chase_kernels)/sizeof(chase_kernels[0]); i++ )
+		if( chase_kernels[i].elem_size == elem_size )
+			return chase_kernels[i].rmw;
+	return chase_rmw_any;
+}
+
+/** @return software prefetch chase kernel */
+chase_fct_ptr prefetch_kernel(){
+	return chase_prefetch;
+}
+
+/**
+ * Split the chain starting at wsetptr into num closed chains of about equal
+ * length and store their first elements in heads.
+ * @return 0 on success, -1 if the chain has less than num elements
+ */
+static int split_chain(list_elem *wsetptr, list_elem **heads, int num){
+	list_elem *lptr = wsetptr;
+	long int len = 0, j;
+	int k;
+
+	do {
+		lptr = lptr->next;
+		len++;
+	} while( lptr != wsetptr );
+	if( len < num )
+		return -1;
+
+	for( k = 0; k < num; k++ ) {
+		list_elem *last;
+		heads[k] = lptr;
+		for( j = 1; j < (k + 1) * len / num - k * len / num; j++ )
+			lptr = lptr->next;
+		last = lptr;
+		lptr = lptr->next;
+		last->next = heads[k];
+	}
+	return 0;
+}
+
+/**
+ * Follow the num chains in chain_heads in lock step, so that num
+ * independent loads are in flight. The chains are kept in registers as far
+ * as possible, lptr is ignored.
+ */
+static inline __attribute__((always_inline))
+list_elem * chase_chains(long int num_accesses, const int num){
+	list_elem *lptr[MAX_CHAINS];
+	long int access_num;
+	int k;
+
+	for( k = 0; k < num; k++ )
+		lptr[k] = chain_heads[k];
+	for( access_num = 0; access_num < num_accesses; access_num += num ) {
+#pragma GCC unroll 32
+		for( k = 0; k < num; k++ )
+			lptr[k] = lptr[k]->next;
+	}
+	for( k = 0; k < num; k++ )
+		chain_heads[k] = lptr[k];
+	return lptr[0];
+}
+
+#define CHAINS_KERNEL(NUM) \
+static list_elem * chase_chains_##NUM(list_elem *lptr, long int num_accesses){ \
+	return chase_chains(num_accesses, NUM); \
+}
+CHAINS_KERNEL(1)  CHAINS_KERNEL(2)  CHAINS_KERNEL(3)  CHAINS_KERNEL(4)
+CHAINS_KERNEL(5)  CHAINS_KERNEL(6)  CHAINS_KERNEL(7)  CHAINS_KERNEL(8)
+CHAINS_KERNEL(9)  CHAINS_KERNEL(10) CHAINS_KERNEL(11) CHAINS_KERNEL(12)
+CHAINS_KERNEL(13) CHAINS_KERNEL(14) CHAINS_KERNEL(15) CHAINS_KERNEL(16)
+CHAINS_KERNEL(17) CHAINS_KERNEL(18) CHAINS_KERNEL(19) CHAINS_KERNEL(20)
+CHAINS_KERNEL(21) CHAINS_KERNEL(22) CHAINS_KERNEL(23) CHAINS_KERNEL(24)
+CHAINS_KERNEL(25) CHAINS_KERNEL(26) CHAINS_KERNEL(27) CHAINS_KERNEL(28)
+CHAINS_KERNEL(29) CHAINS_KERNEL(30) CHAINS_KERNEL(31) CHAINS_KERNEL(32)
+
+static const chase_fct_ptr chase_chains_kernels[MAX_CHAINS + 1] = { NULL,
+	chase_chains_1,  chase_chains_2,  chase_chains_3,  chase_chains_4,
+	chase_chains_5,  chase_chains_6,  chase_chains_7,  chase_chains_8,
+	chase_chains_9,  chase_chains_10, chase_chains_11, chase_chains_12,
+	chase_chains_13, chase_chains_14, chase_chains_15, chase_chains_16,
+	chase_chains_17, chase_chains_18, chase_chains_19, chase_chains_20,
+	chase_chains_21, chase_chains_22, chase_chains_23, chase_chains_24,
+	chase_chains_25, chase_chains_26, chase_chains_27, chase_chains_28,
+	chase_chains_29, chase_chains_30, chase_chains_31, chase_chains_32
+};
+
+long int test_read(long int size, list_elem *wsetptr) {
+	if( num_chains > 1 ) {
+		/* num_chains independent chains within the same working set */
+		if( wsetptr == NULL || split_chain( wsetptr, chain_heads, num_chains ) != 0 )
+			return 0;
+		return test_chase( size, wsetptr, chase_chains_kernels[num_chains] );
+	}
+	return test_chase( size, wsetptr, read_kernel() );
+}
+
+long int test_write(long int size, list_elem *wsetptr) {
+	return test_chase( size, wsetptr, write_kernel() );
+}
+
+long int test_rmw(long int size, list_elem *wsetptr) {
+	return test_chase( size, wsetptr, rmw_kernel() );
+}
+
+/**
+ * Replay the trace on the working set of size Byte at wsetptr like the read
+ * kernel and write one result line. The window of the first trace_window
+ * entries is folded into the working set as element indices before the
+ * measurement, offsets beyond it wrap around, so a working set of at least
+ * the trace range (trace_max - trace_min) replays the original layout.
+ * Every repetition replays the window at least NUM_ACCESS_FACTOR times,
+ * continuing where the previous one stopped. The offsets stream through the
+ * caches in addition to the working set, 4 Byte per access.
+ * @return final list pointer as long to keep the traversal alive
+ */
+long int test_trace(long int size, list_elem *wsetptr) {
+	long int i, num_elem = size / elem_size;
+
+	if( wsetptr == NULL )
+		return 0;
+	for( i = 0; i < trace_window; i++ )
+		trace_offsets[i] = (uint32_t) ((trace_entries[i] - trace_min) / elem_size % num_elem);
+	trace_pos = 0;
+	chain_length = trace_window;
+	return test_chase( size, wsetptr, chase_trace );
+}
+
+/**
+ * Record the traversal order of the chain at wsetptr in prefetch_path and
+ * time the software prefetch chase along it.
+ */
+long int test_prefetch(long int size, list_elem *wsetptr) {
+	long int max_len = size / elem_size + 1, ret;
+	list_elem *lptr;
+
+	if( wsetptr == NULL )
+		return 0;
+	prefetch_path = (list_elem **) malloc( max_len * sizeof(list_elem *) );
+	if( prefetch_path == NULL ) {
+		fprintf(stderr, "ERROR: Allocation of the prefetch path of %ld Bytes failed.\n", max_len * (long) sizeof(list_elem *));
+		exit(1);
+	}
+	prefetch_path_len = 0;
+	lptr = wsetptr;
+	do {
+		prefetch_path[prefetch_path_len++] = lptr;
+		lptr = lptr->next;
+	} while( lptr != wsetptr && prefetch_path_len < max_len );
+	prefetch_pos = 0;
+	ret = test_chase( size, wsetptr, chase_prefetch );
+	free( prefetch_path );
+	prefetch_path = NULL;
+	return ret;
+}
+
+/***********************************************************************
+ * multi-threaded runs
+ ***********************************************************************/
+/** start gate of a threaded run, state 1 starts the threads, -1 makes them
+ * return without running, e.g. if not all of them could be created */
+typedef struct {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	int state;
+} thread_gate;
+
+/** per thread data of a threaded run */
+typedef struct {
+	int id;                /**< thread number */
+	int cpu;               /**< CPU the thread is pinned to */
+	long int size;         /**< working set size */
+	init_fct_ptr init;     /**< pattern generator for private chains */
+	chase_fct_ptr chase;   /**< access kernel */
+	list_elem *wsetptr;    /**< shared chain or NULL to create a private one */
+	list_elem *chain;      /**< chain used by the thread */
+	long int start_offset; /**< steps to advance in the chain before the run */
+	thread_gate *gate;
+	pthread_barrier_t *barrier;
+	volatile int *stop;
+	long int num_accesses; /**< result: accesses done until the deadline */
+	double etime;          /**< result: elapsed time */
+	ticks ticks;           /**< result: elapsed ticks */
+	long int result;
+	int error;
+} thread_data;
+
+static void * test_thread(void *arg){
+	thread_data *td = (thread_data *) arg;
+	list_elem *wsetptr = td->wsetptr;
+	list_elem *lptr;
+	cpu_set_t cpuset;
+	double start;
+	ticks ticks1;
+	int state;
+
+	/* the barrier counts all threads, so it is only entered once all exist */
+	pthread_mutex_lock( &td->gate->lock );
+	while( (state = td->gate->state) == 0 )
+		pthread_cond_wait( &td->gate->cond, &td->gate->lock );
+	pthread_mutex_unlock( &td->gate->lock );
+	if( state < 0 )
+		return NULL;
+
+	CPU_ZERO(&cpuset);
+	CPU_SET(td->cpu, &cpuset);
+	if( pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0 ) {
+		fprintf(stderr, "WARNING: Could not pin thread %d to CPU %d\n", td->id, td->cpu);
+	}
+	/* private chains are initialized by the thread itself for first touch placement */
+	if( wsetptr == NULL )
+		wsetptr = td->init( (list_elem *) alloc_wset( td->size ), td->size );
+	td->error = (wsetptr == NULL);
+	lptr = wsetptr;
+	if( lptr != NULL ) {
+		lptr = td->chase( lptr, td->start_offset );
+		if( flush_mode == FLUSH_WARM )
+			lptr = td->chase( lptr, chain_length );
+	}
+	td->chain = wsetptr;
+
+	pthread_barrier_wait( td->barrier ); /* ready */
+	pthread_barrier_wait( td->barrier ); /* start */
+
+	td->num_accesses = 0;
+	start = timer();
+	ticks1 = tsc_begin();
+	if( lptr != NULL ) {
+		while( !__atomic_load_n( td->stop, __ATOMIC_RELAXED ) ) {
+			lptr = td->chase( lptr, THREAD_CHUNK );
+			td->num_accesses += THREAD_CHUNK;
+		}
+	}
+	td->ticks = tsc_end() - ticks1;
+	td->etime = timer() - start;
+	td->result = (long) lptr;
+
+	if( td->wsetptr == NULL )
+		free_wset( wsetptr, td->size );
+	return NULL;
+}
+
+/**
+ * Run num_threads pinned threads on working sets of size Byte which start
+ * behind a barrier and stop on a common deadline after point_duration seconds.
+ * Each thread uses a private chain generated by init or all threads share one
+ * chain, starting at evenly spread positions. Writes the aggregate and the
+ * per thread access rates to the log file, threads which finished no chunk
+ * are left out of the average and points without any samples are skipped.
+ * @return sum of the final list pointers, -1 in case of an error
+ */
+long int test_threads(long int size, init_fct_ptr init, chase_fct_ptr chase){
+	pthread_t threads[num_threads];
+	thread_data data[num_threads];
+	pthread_barrier_t barrier;
+	thread_gate gate = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0 };
+	volatile int stop = 0;
+	list_elem *wsetptr = NULL;
+	struct timespec deadline;
+	long int result = 0;
+	long int total_accesses = 0;
+	double ticks_per_access = 0.;
+	double max_etime = 0.;
+	int t, num_created, num_sampled = 0, error = 0;
+
+	if( shared_chain )
+		wsetptr = init( (list_elem *) arena, size );
+	pthread_barrier_init( &barrier, NULL, num_threads + 1 );
+	for( t = 0; t < num_threads; t++ ) {
+		data[t].id = t;
+		data[t].cpu = thread_cpus[t % num_thread_cpus];
+		data[t].size = size;
+		data[t].init = init;
+		data[t].chase = chase;
+		data[t].wsetptr = wsetptr;
+		data[t].start_offset = shared_chain ? t * chain_length / num_threads : 0;
+		data[t].gate = &gate;
+		data[t].barrier = &barrier;
+		data[t].stop = &stop;
+		if( pthread_create( &threads[t], NULL, test_thread, &data[t] ) != 0 )
+			break;
+	}
+	num_created = t;
+	pthread_mutex_lock( &gate.lock );
+	gate.state = (num_created == num_threads) ? 1 : -1;
+	pthread_cond_broadcast( &gate.cond );
+	pthread_mutex_unlock( &gate.lock );
+	if( num_created < num_threads ) {
+		fprintf(stderr, "ERROR: Could not create thread %d of %d.\n", num_created, num_threads);
+		for( t = 0; t < num_created; t++ )
+			pthread_join( threads[t], NULL );
+		pthread_barrier_destroy( &barrier );
+		return -1;
+	}
+
+	pthread_barrier_wait( &barrier ); /* all chains ready */
+	/* flush the chains of all threads, but write the eviction buffer once */
+	for( t = 0; t < num_threads; t++ ) {
+		if( data[t].chain != NULL && (t == 0 || (!shared_chain && flush_mode != FLUSH_EVICT)) )
+			clear_cache( data[t].chain, size );
+	}
+	pthread_barrier_wait( &barrier ); /* start */
+	deadline.tv_sec = (time_t) point_duration;
+	deadline.tv_nsec = (long) ((point_duration - deadline.tv_sec) * 1e9);
+	while( nanosleep( &deadline, &deadline ) != 0 && errno == EINTR )
+		;
+	__atomic_store_n( &stop, 1, __ATOMIC_RELAXED );
+
+	for( t = 0; t < num_threads; t++ ) {
+		pthread_join( threads[t], NULL );
+		error |= data[t].error;
+		result += data[t].result;
+		total_accesses += data[t].num_accesses;
+		/* a thread which finished no chunk before the deadline has no samples */
+		if( data[t].num_accesses > 0 ) {
+			ticks_per_access += (double) data[t].ticks / data[t].num_accesses;
+			num_sampled++;
+		}
+		else if( !data[t].error ) {
+			fprintf(stderr, "WARNING: Thread %d finished no chunk of %d accesses at %ld Bytes, it has no samples.\n",
+			        t, THREAD_CHUNK, size);
+		}
+		if( data[t].etime > max_etime )
+			max_etime = data[t].etime;
+	}
+	pthread_barrier_destroy( &barrier );
+	if( error )
+		return -1;
+	if( num_sampled == 0 )
+		return result;
+	ticks_per_access /= num_sampled;
+
+	fprintf( logfile, "%12.ld %10.6lf %16.2lf %8.1lf %8.2lf", size, max_etime, total_accesses / max_etime,
+	         ticks_per_access, ticks_per_access / tsc_ghz );
+	for( t = 0; t < num_threads; t++ ) {
+		if( data[t].num_accesses > 0 )
+			fprintf( logfile, " %16.2lf", data[t].num_accesses / data[t].etime );
+		else
+			fprintf( logfile, " %16s", "-" );
+	}
+	fprintf( logfile, "\n" );
+	fflush(logfile);
+	record_point( size, ticks_per_access, ticks_per_access / tsc_ghz );
+	result_row row = { size, max_etime, ticks_per_access, ticks_per_access / tsc_ghz, NAN, NAN, NULL, NULL, -1, -1 };
+	report_row( &row );
+
+	return result;
+}
+
+/**
+ * Parse a comma separated list of numbers and ranges (e.g. 0-3,8) as used
+ * for CPU and node lists into ids.
+ * @return number of parsed ids, -1 in case of an invalid entry
+ */
+int parse_id_list(const char *list, int *ids, int max_ids){
+	char buf[1024];
+	char *ptr;
+	int n = 0;
+
+	strncpy(buf, list, sizeof(buf) - 1);
+	buf[sizeof(buf) - 1] = '\0';
+	for(ptr = strtok(buf, ",\n"); ptr != NULL; ptr = strtok(NULL, ",\n")) {
+		int first, last, id;
+		int fields = sscanf(ptr, "%d-%d", &first, &last);
+		if(fields == 1)
+			last = first;
+		if(fields < 1 || first < 0 || last < first || n + last - first >= max_ids) {
+			fprintf(stderr, "ERROR: Invalid list entry '%s'.\n", ptr);
+			return -1;
+		}
+		for(id = first; id <= last; id++)
+			ids[n++] = id;
+	}
+	return n;
+}
+
+/**
+ * Fill thread_cpus with the CPUs the process is allowed to run on.
+ * @return number of CPUs
+ */
+int default_cpu_list(){
+	cpu_set_t cpuset;
+	int cpu, n = 0;
+
+	if( sched_getaffinity(0, sizeof(cpuset), &cpuset) != 0 )
+		return 0;
+	for(cpu = 0; cpu < CPU_SETSIZE && n < MAX_CPUS; cpu++)
+		if( CPU_ISSET(cpu, &cpuset) )
+			thread_cpus[n++] = cpu;
+	return n;
+}
+
+/***********************************************************************
+ * NUMA matrix
+ ***********************************************************************/
+/**
+ * Read the first line of a small sysfs file.
+ * @return 0 on success, -1 otherwise
+ */
+int read_sysfs(const char *path, char *buf, int len){
+	FILE *fp = fopen(path, "r");
+	if( fp == NULL )
+		return -1;
+	if( fgets(buf, len, fp) == NULL ) {
+		fclose(fp);
+		return -1;
+	}
+	fclose(fp);
+	return 0;
+}
+
+/**
+ * Bind all following first touch allocations of the calling thread to node,
+ * node < 0 restores the default policy.
+ */
+static int bind_memory(int node){
+	unsigned long nodemask[MAX_NUMA_NODES / (8 * sizeof(unsigned long)) + 1] = { 0 };
+
+	if( node < 0 )
+		return syscall(SYS_set_mempolicy, MPOL_DEFAULT, NULL, 0);
+	if( node >= MAX_NUMA_NODES ) {
+		errno = EINVAL;
+		return -1;
+	}
+	nodemask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+	return syscall(SYS_set_mempolicy, MPOL_BIND, nodemask, MAX_NUMA_NODES + 1);
+}
+
+/**
+ * Measure the latency and read bandwidth between all pairs of NUMA memory
+ * nodes and CPU nodes in one process. For each memory node one random chain
+ * of wset_final_size Byte is placed on the node and then accessed from the
+ * CPUs of every node in turn. Latency is measured by the random chase,
+ * bandwidth by a sequential read of the same memory.
+ * @return 0 on success, 1 otherwise
+ */
+int numa_matrix(){
+	char buf[4096], path[256];
+	int nodes[MAX_NUMA_NODES];
+	int num_nodes, m, c;
+	long int size = wset_final_size;
+	cpu_set_t orig_cpuset;
+	cpu_set_t node_cpusets[MAX_NUMA_NODES];
+	double latency[MAX_NUMA_NODES][MAX_NUMA_NODES];
+	double tick_latency[MAX_NUMA_NODES][MAX_NUMA_NODES];
+	double bandwidth[MAX_NUMA_NODES][MAX_NUMA_NODES];
+	long int result = 0;
+
+	if( read_sysfs("/sys/devices/system/node/online", buf, sizeof(buf)) != 0 ) {
+		strcpy(buf, "0");
+	}
+	num_nodes = parse_id_list(buf, nodes, MAX_NUMA_NODES);
+	if( num_nodes <= 0 )
+		return 1;
+	/* node ids can be sparse, but the node mask of bind_memory only holds
+	 * ids below MAX_NUMA_NODES */
+	for( m = c = 0; c < num_nodes; c++ ) {
+		if( nodes[c] < MAX_NUMA_NODES )
+			nodes[m++] = nodes[c];
+		else
+			fprintf(stderr, "WARNING: Skipping NUMA node %d, ids have to be below %d.\n", nodes[c], MAX_NUMA_NODES);
+	}
+	num_nodes = m;
+	if( num_nodes == 0 )
+		return 1;
+	for( c = 0; c < num_nodes; c++ ) {
+		int cpus[MAX_CPUS];
+		int i, num_cpus;
+		snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", nodes[c]);
+		CPU_ZERO(&node_cpusets[c]);
+		if( read_sysfs(path, buf, sizeof(buf)) != 0 || buf[0] == '\n' ) {
+			num_cpus = 0; /* memory only node */
+		}
+		else {
+			num_cpus = parse_id_list(buf, cpus, MAX_CPUS);
+		}
+		for( i = 0; i < num_cpus; i++ )
+			CPU_SET(cpus[i], &node_cpusets[c]);
+	}
+	sched_getaffinity(0, sizeof(orig_cpuset), &orig_cpuset);
+
+	for( m = 0; m < num_nodes; m++ ) {
+		list_elem *wsetptr;
+		if( bind_memory(nodes[m]) != 0 ) {
+			fprintf(stderr, "ERROR: Could not bind memory to node %d: %s\n", nodes[m], strerror(errno));
+			return 1;
+		}
+		wsetptr = init_random( (list_elem *) alloc_wset( size ), size );
+		bind_memory(-1);
+		if( wsetptr == NULL )
+			return 1;
+
+		for( c = 0; c < num_nodes; c++ ) {
+			list_elem *lptr = wsetptr;
+			const long *data = (const long *) wsetptr;
+			long int num_longs = size / sizeof(long);
+			long int num_accesses, pass, j, sum = 0;
+			double start, etime, ovh_ticks, ovh_sec;
+			ticks ticks1, ticks2;
+
+			latency[m][c] = tick_latency[m][c] = bandwidth[m][c] = NAN;
+			if( CPU_COUNT(&node_cpusets[c]) == 0 || sched_setaffinity(0, sizeof(cpu_set_t), &node_cpusets[c]) != 0 )
+				continue;
+
+			num_accesses = calibrate_accesses( &lptr, chase_read, NUM_ACCESS_FACTOR * (size / elem_size) );
+			measure_overhead( lptr, chase_read, &ovh_ticks, &ovh_sec );
+			if( flush_mode == FLUSH_WARM )
+				lptr = chase_read( lptr, size / elem_size / wset_stride );
+			else
+				clear_cache( wsetptr, size );
+			ticks1 = tsc_begin();
+			lptr = chase_read( lptr, num_accesses );
+			ticks2 = tsc_end();
+			tick_latency[m][c] = (ticks2 - ticks1 - ovh_ticks) / num_accesses;
+			latency[m][c] = tick_latency[m][c] / tsc_ghz;
+			result += (long) lptr;
+
+			clear_cache( data, size );
+			start = timer();
+			for( pass = 0; pass < NUM_ACCESS_FACTOR; pass++ )
+				for( j = 0; j < num_longs; j++ )
+					sum += data[j];
+			etime = timer() - start;
+			bandwidth[m][c] = (double) NUM_ACCESS_FACTOR * num_longs * sizeof(long) / etime / 1e9;
+			result += sum;
+		}
+		free_wset( wsetptr, size );
+	}
+	sched_setaffinity(0, sizeof(orig_cpuset), &orig_cpuset);
+
+	row_test = "numa";
+	row_pattern = "random";
+	row_kernel = "read";
+	for( m = 0; m < num_nodes; m++ ) {
+		for( c = 0; c < num_nodes; c++ ) {
+			result_row row = { size, NAN, tick_latency[m][c], latency[m][c], NAN, bandwidth[m][c], NULL, NULL, nodes[m], nodes[c] };
+			report_row( &row );
+		}
+	}
+
+	const char *titles[] = { "latency [ns/access]", "latency [ticks/access]", "read bandwidth [GB/s]" };
+	double (*matrices[])[MAX_NUMA_NODES] = { latency, tick_latency, bandwidth };
+	int k;
+	for( k = 0; k < 3; k++ ) {
+		fprintf( logfile, "# NUMA %s, rows: memory node, columns: CPU node\n", titles[k] );
+		fprintf( logfile, "# %6s", "mnode" );
+		for( c = 0; c < num_nodes; c++ )
+			fprintf( logfile, " %10d", nodes[c] );
+		fprintf( logfile, "\n" );
+		for( m = 0; m < num_nodes; m++ ) {
+			fprintf( logfile, "%8d", nodes[m] );
+			for( c = 0; c < num_nodes; c++ )
+				fprintf( logfile, " %10.2lf", matrices[k][m][c] );
+			fprintf( logfile, "\n" );
+		}
+		fprintf( logfile, "\n\n" );
+	}
+	fprintf( logfile, "# Result: %ld\n", result );
+	fflush( logfile );
+	return 0;
+}
+
+/***********************************************************************
+ * bandwidth kernels
+ ***********************************************************************/
+/* streaming operations, a is the destination, b and c are the sources */
+typedef enum { BW_READ, BW_WRITE, BW_COPY, BW_SCALE, BW_ADD, BW_TRIAD, BW_NUM_OPS } bw_op_t;
+const char *bw_op_names[BW_NUM_OPS] = { "read", "write", "copy", "scale", "add", "triad" };
+/* number of arrays accessed by each operation */
+const int bw_op_arrays[BW_NUM_OPS] = { 1, 1, 2, 2, 3, 3 };
+int bw_execute[BW_NUM_OPS] = { 0 };
+
+typedef double (*bw_fct_ptr)(double *a, const double *b, const double *c, double s, long int n);
+
+#if defined(__x86_64__) || defined(__i386__)
+static inline void stream_double(double *p, double v){
+	long long x;
+	memcpy(&x, &v, sizeof(x));
+	_mm_stream_si64((long long *) p, x);
+}
+#define BW_SFENCE() _mm_sfence()
+#else
+/* no non-temporal stores, --nt only keeps the fence */
+static inline void stream_double(double *p, double v){
+	*p = v;
+}
+#define BW_SFENCE() __sync_synchronize()
+#endif
+
+#define SCALAR_LOADU(p)     (*(p))
+#define SCALAR_STORE(p, v)  (*(p) = (v))
+#define SCALAR_SET1(s)      (s)
+#define SCALAR_ADD(x, y)    ((x) + (y))
+#define SCALAR_MUL(x, y)    ((x) * (y))
+#define SCALAR_HSUM(v)      (v)
+
+#if defined(__x86_64__) || defined(__i386__)
+static inline __attribute__((target("sse2"))) double hsum_sse2(__m128d v){
+	return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+static inline __attribute__((target("avx2"))) double hsum_avx2(__m256d v){
+	return hsum_sse2(_mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1)));
+}
+static inline __attribute__((target("avx512f"))) double hsum_avx512(__m512d v){
+	return _mm512_reduce_add_pd(v);
+}
+#endif
+
+/* one vector of W doubles at offset i + j * W, op and nt are compile-time
+ * constants in the generated kernels */
+#define BW_STEP(j, VEC, W, LOADU, STORE, STREAM, ADD, MUL) { \
+	double *pa = a + i + j * W; \
+	const double *pb = b + i + j * W, *pc = c + i + j * W; \
+	VEC v; \
+	switch( op ) { \
+		case BW_READ:  acc##j = ADD(acc##j, LOADU(pa)); continue; \
+		case BW_WRITE: v = vs; break; \
+		case BW_COPY:  v = LOADU(pb); break; \
+		case BW_SCALE: v = MUL(vs, LOADU(pb)); break; \
+		case BW_ADD:   v = ADD(LOADU(pb), LOADU(pc)); break; \
+		default:       v = ADD(LOADU(pb), MUL(vs, LOADU(pc))); break; \
+	} \
+	if( nt ) STREAM(pa, v); else STORE(pa, v); \
+}
+
+/*
+ * Generate the bandwidth kernels for one instruction set. The loop is
+ * unrolled four times with independent accumulators for the read kernel,
+ * so n has to be a multiple of 4 * W.
+ */
+#define BW_KERNELS(ISA, ATTR, VEC, W, LOADU, STORE, STREAM, SET1, ADD, MUL, HSUM) \
+static inline __attribute__((always_inline, ATTR)) \
+double bw_##ISA(const int op, const int nt, double *a, const double *b, const double *c, double s, long int n){ \
+	VEC vs = SET1(s); \
+	VEC acc0 = SET1(0.), acc1 = SET1(0.), acc2 = SET1(0.), acc3 = SET1(0.); \
+	long int i; \
+	for( i = 0; i < n; i += 4 * W ) { \
+		do BW_STEP(0, VEC, W, LOADU, STORE, STREAM, ADD, MUL) while(0); \
+		do BW_STEP(1, VEC, W, LOADU, STORE, STREAM, ADD, MUL) while(0); \
+		do BW_STEP(2, VEC, W, LOADU, STORE, STREAM, ADD, MUL) while(0); \
+		do BW_STEP(3, VEC, W, LOADU, STORE, STREAM, ADD, MUL) while(0); \
+	} \
+	if( nt ) \
+		BW_SFENCE(); \
+	return HSUM(ADD(ADD(acc0, acc1), ADD(acc2, acc3))); \
+} \
+BW_WRAPPERS(ISA, ATTR, read,  BW_READ) \
+BW_WRAPPERS(ISA, ATTR, write, BW_WRITE) \
+BW_WRAPPERS(ISA, ATTR, copy,  BW_COPY) \
+BW_WRAPPERS(ISA, ATTR, scale, BW_SCALE) \
+BW_WRAPPERS(ISA, ATTR, add,   BW_ADD) \
+BW_WRAPPERS(ISA, ATTR, triad, BW_TRIAD)
+
+#define BW_WRAPPERS(ISA, ATTR, NAME, OP) \
+static __attribute__((ATTR)) double bw_##ISA##_##NAME(double *a, const double *b, const double *c, double s, long int n){ \
+	return bw_##ISA(OP, 0, a, b, c, s, n); \
+} \
+static __attribute__((ATTR)) double bw_##ISA##_##NAME##_nt(double *a, const double *b, const double *c, double s, long int n){ \
+	return bw_##ISA(OP, 1, a, b, c, s, n); \
+}
+
+BW_KERNELS(scalar, optimize("no-tree-vectorize"), double, 1, SCALAR_LOADU, SCALAR_STORE, stream_double,
+           SCALAR_SET1, SCALAR_ADD, SCALAR_MUL, SCALAR_HSUM)
+#if defined(__x86_64__) || defined(__i386__)
+BW_KERNELS(sse2, target("sse2"), __m128d, 2, _mm_loadu_pd, _mm_store_pd, _mm_stream_pd,
+           _mm_set1_pd, _mm_add_pd, _mm_mul_pd, hsum_sse2)
+BW_KERNELS(avx2, target("avx2"), __m256d, 4, _mm256_loadu_pd, _mm256_store_pd, _mm256_stream_pd,
+           _mm256_set1_pd, _mm256_add_pd, _mm256_mul_pd, hsum_avx2)
+BW_KERNELS(avx512, target("avx512f"), __m512d, 8, _mm512_loadu_pd, _mm512_store_pd, _mm512_stream_pd,
+           _mm512_set1_pd, _mm512_add_pd, _mm512_mul_pd, hsum_avx512)
+#endif
+
+#define BW_TABLE(ISA) { \
+	{ bw_##ISA##_read,  bw_##ISA##_read_nt  }, \
+	{ bw_##ISA##_write, bw_##ISA##_write_nt }, \
+	{ bw_##ISA##_copy,  bw_##ISA##_copy_nt  }, \
+	{ bw_##ISA##_scale, bw_##ISA##_scale_nt }, \
+	{ bw_##ISA##_add,   bw_##ISA##_add_nt   }, \
+	{ bw_##ISA##_triad, bw_##ISA##_triad_nt } }
+
+/** bandwidth kernels per instruction set, ordered by preference */
+static const struct {
+	const char *name;
+	const char *cpu_feature;       /**< feature required for __builtin_cpu_supports */
+	bw_fct_ptr kernels[BW_NUM_OPS][2]; /**< regular and non-temporal stores */
+} bw_isas[] = {
+#if defined(__x86_64__) || defined(__i386__)
+	{ "avx512", "avx512f", BW_TABLE(avx512) },
+	{ "avx2",   "avx2",    BW_TABLE(avx2)   },
+	{ "sse2",   "sse2",    BW_TABLE(sse2)   },
+#endif
+	{ "scalar", NULL,      BW_TABLE(scalar) },
+};
+
+/**
+ * Check whether the CPU supports the instruction set with index isa.
+ */
+static int bw_isa_supported(int isa){
+	const char *feature = bw_isas[isa].cpu_feature;
+	if( feature == NULL )
+		return 1;
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	/* __builtin_cpu_supports requires a string literal */
+	if( strcmp(feature, "avx512f") == 0 )
+		return __builtin_cpu_supports("avx512f");
+	if( strcmp(feature, "avx2") == 0 )
+		return __builtin_cpu_supports("avx2");
+	if( strcmp(feature, "sse2") == 0 )
+		return __builtin_cpu_supports("sse2");
+#endif
+	return 0;
+}
+
+/**
+ * Select the bandwidth instruction set by name, "auto" selects the best one
+ * supported by the CPU.
+ * @return index into bw_isas, -1 if unknown or not supported
+ */
+int select_bw_isa(const char *name){
+	int i;
+	for( i = 0; i < sizeof(bw_isas)/sizeof(bw_isas[0]); i++ ) {
+		if( strcmp(name, "auto") == 0 || strcmp(name, bw_isas[i].name) == 0 ) {
+			if( bw_isa_supported(i) )
+				return i;
+			if( strcmp(name, "auto") != 0 )
+				break;
+		}
+	}
+	return -1;
+}
+
+/**
+ * Working set size in Byte actually streamed by op for size Byte, whose
+ * arrays are rounded down to whole unrolled blocks.
+ */
+long int bw_bytes(long int size, bw_op_t op){
+	const int num_arrays = bw_op_arrays[op];
+	const long int block = 4 * CACHE_LINE_SIZE / sizeof(double);
+	return size / num_arrays / sizeof(double) / block * block * num_arrays * sizeof(double);
+}
+
+/**
+ * Measure the bandwidth of a streaming operation on a working set of size
+ * Byte shared evenly by the arrays of the operation. The arrays are warmed
+ * up by initialization, so the result reflects the cache level the working
+ * set fits in. The size and bandwidth are written to the log file and the
+ * ticks and nanoseconds per Byte recorded as sweep point.
+ * @return checksum of the run
+ */
+long int test_bandwidth(long int size, bw_op_t op){
+	const int num_arrays = bw_op_arrays[op];
+	long int bytes = bw_bytes( size, op );
+	long int n = bytes / num_arrays / sizeof(double);
+	long int num_passes, pass, i, a;
+	double bandwidths[MAX_REPETITIONS], tick_counts[MAX_REPETITIONS];
+	stats_t bw_stats, tick_stats;
+	int rep;
+	bw_fct_ptr kernel = bw_isas[bw_isa].kernels[op][bw_nt];
+	double *arrays[3];
+	double start, result = 0.;
+	ticks ticks1, ticks2;
+	char *mem;
+
+	if( n == 0 )
+		return 0;
+	mem = arena;
+	for( i = 0; i < 3; i++ ) {
+		/* aligned to cache lines as required by the non-temporal stores,
+		 * arrays not used by the operation are never accessed */
+		a = (i < num_arrays) ? i : 0;
+		arrays[i] = (double *) (((uintptr_t) mem + a * (n * sizeof(double) + CACHE_LINE_SIZE) + CACHE_LINE_SIZE - 1)
+		                        / CACHE_LINE_SIZE * CACHE_LINE_SIZE);
+	}
+	for( a = 0; a < num_arrays; a++ )
+		for( i = 0; i < n; i++ )
+			arrays[a][i] = a;
+
+	/* calibrate the number of passes to point_duration like calibrate_accesses */
+	for( num_passes = 1; ; num_passes *= 4 ) {
+		double etime;
+		start = timer();
+		for( pass = 0; pass < num_passes; pass++ )
+			result += kernel( arrays[0], arrays[1], arrays[2], 3., n );
+		etime = timer() - start;
+		if( etime >= CALIBRATION_FRACTION * point_duration ) {
+			num_passes = (long int) (num_passes * point_duration / etime);
+			break;
+		}
+	}
+	if( num_passes < NUM_ACCESS_FACTOR )
+		num_passes = NUM_ACCESS_FACTOR;
+
+	for( rep = 0; rep == 0 || need_repetition( bandwidths, rep ); rep++ ) {
+		start = timer();
+		ticks1 = tsc_begin();
+		for( pass = 0; pass < num_passes; pass++ )
+			result += kernel( arrays[0], arrays[1], arrays[2], 3., n );
+		ticks2 = tsc_end();
+		bandwidths[rep] = (double) num_passes * bytes / (timer() - start) / 1e9;
+		tick_counts[rep] = (double) (ticks2 - ticks1) / num_passes / bytes;
+	}
+	compute_stats( bandwidths, rep, &bw_stats );
+	compute_stats( tick_counts, rep, &tick_stats );
+
+	fprintf( logfile, "%12.ld %10.6lf %16.2lf %8.3lf", bytes, (double) num_passes * bytes / (bw_stats.median * 1e9),
+	         bw_stats.median, tick_stats.median );
+	log_stats( &bw_stats );
+	fprintf( logfile, "\n" );
+	fflush( logfile );
+	record_point( bytes, tick_stats.median, 1. / bw_stats.median );
+	result_row row = { bytes, (double) num_passes * bytes / (bw_stats.median * 1e9), NAN, NAN, tick_stats.median,
+	                   bw_stats.median, (rep > 1) ? &bw_stats : NULL, NULL, -1, -1 };
+	report_row( &row );
+
+	result += arrays[0][n - 1];
+	return (long) result;
+}
+
+/***********************************************************************
+ * cache hierarchy detection
+ ***********************************************************************/
+/* minimum relative latency step between two levels */
+#ifndef LEVEL_MIN_STEP
+#define LEVEL_MIN_STEP 0.8
+#endif
+
+/* maximum slope of log(latency) over log(size) on a plateau, steeper
+ * segments are transitions between levels */
+#ifndef LEVEL_MAX_SLOPE
+#define LEVEL_MAX_SLOPE 0.5
+#endif
+
+/* minimum number of points of a plateau */
+#ifndef LEVEL_MIN_POINTS
+#define LEVEL_MIN_POINTS 4
+#endif
+
+#ifndef MAX_CACHE_LEVELS
+#define MAX_CACHE_LEVELS 8
+#endif
+
+/** cache level detected from the latency curve */
+typedef struct {
+	long int first, last; /**< range of plateau points in sweep_points */
+	long int capacity;    /**< largest working set size on the plateau, 0 for main memory */
+	double ticks;         /**< median ticks per access on the plateau */
+	double ns;            /**< median ns per access on the plateau */
+} cache_level;
+
+/**
+ * Median of the ticks (ns = 0) or ns (ns = 1) of the points first..last.
+ */
+static double median_points(long int first, long int last, int ns){
+	long int n = last - first + 1, i;
+	double *values = malloc( n * sizeof(double) ), median;
+	if( values == NULL )
+		return NAN;
+	for( i = 0; i < n; i++ )
+		values[i] = ns ? sweep_points[first + i].ns : sweep_points[first + i].ticks;
+	qsort( values, n, sizeof(double), compare_double );
+	median = (n % 2) ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+	free( values );
+	return median;
+}
+
+/**
+ * Binary segmentation of the curve y[first..last] of log latencies into
+ * piecewise constant segments, sum and sum2 are the prefix sums of y and
+ * y^2. A segment is split at the point minimizing the squared error of both
+ * parts if the ratio of their mean latencies exceeds 1 + LEVEL_MIN_STEP,
+ * i.e. their means of y differ by more than log(1 + LEVEL_MIN_STEP). The
+ * first points of the resulting segments are marked in is_split.
+ */
+static void split_segments(const double *sum, const double *sum2, long int first, long int last, char *is_split){
+	long int k, best = -1;
+	double best_cost = INFINITY;
+
+	for( k = first + LEVEL_MIN_POINTS; k + LEVEL_MIN_POINTS <= last + 1; k++ ) {
+		double n1 = k - first, n2 = last + 1 - k;
+		double s1 = sum[k] - sum[first], s2 = sum[last + 1] - sum[k];
+		double cost = (sum2[k] - sum2[first]) - s1 * s1 / n1 + (sum2[last + 1] - sum2[k]) - s2 * s2 / n2;
+		if( cost < best_cost ) {
+			best_cost = cost;
+			best = k;
+		}
+	}
+	if( best < 0 )
+		return;
+	double mean1 = (sum[best] - sum[first]) / (best - first);
+	double mean2 = (sum[last + 1] - sum[best]) / (last + 1 - best);
+	if( fabs(mean2 - mean1) < log(1. + LEVEL_MIN_STEP) )
+		return;
+	is_split[best] = 1;
+	split_segments( sum, sum2, first, best - 1, is_split );
+	split_segments( sum, sum2, best, last, is_split );
+}
+
+/**
+ * Slope of the least squares fit of log(ticks) over log(size) for the
+ * points first..last.
+ */
+static double loglog_slope(long int first, long int last){
+	double sx = 0., sy = 0., sxx = 0., sxy = 0.;
+	long int i, n = last - first + 1;
+	for( i = first; i <= last; i++ ) {
+		double x = log( (double) sweep_points[i].size ), y = log( sweep_points[i].ticks );
+		sx += x; sy += y; sxx += x * x; sxy += x * y;
+	}
+	if( n < 2 || n * sxx - sx * sx <= 0. )
+		return 0.;
+	return (n * sxy - sx * sy) / (n * sxx - sx * sx);
+}
+
+/**
+ * Detect the cache levels from the latency curve in sweep_points.
+ * The median filtered log latency is split into piecewise constant segments
+ * by binary segmentation. Segments whose latency still rises steeply with
+ * the size are transitions, the remaining ones are the plateaus of the
+ * levels. The capacity of a level is the largest size on its plateau, it
+ * is 0 for a plateau reaching the end of the sweep.
+ * @return number of detected levels
+ */
+int detect_levels(cache_level *levels, int max_levels){
+	long int n = num_sweep_points, i, j;
+	double *y, *sum, *sum2;
+	char *is_split;
+	int num_levels = 0;
+
+	if( n < 2 * LEVEL_MIN_POINTS )
+		return 0;
+	y = malloc( n * sizeof(double) );
+	sum = malloc( (n + 1) * sizeof(double) );
+	sum2 = malloc( (n + 1) * sizeof(double) );
+	is_split = calloc( n + 1, 1 );
+	if( y == NULL || sum == NULL || sum2 == NULL || is_split == NULL ) {
+		free( y ); free( sum ); free( sum2 ); free( is_split );
+		return 0;
+	}
+	/* median filter of width 5 removes single outliers */
+	for( i = 0; i < n; i++ ) {
+		long int first = (i < 2) ? 0 : i - 2;
+		long int last = (i + 2 >= n) ? n - 1 : i + 2;
+		double window[5];
+		for( j = first; j <= last; j++ )
+			window[j - first] = sweep_points[j].ticks;
+		qsort( window, last - first + 1, sizeof(double), compare_double );
+		y[i] = log( window[(last - first) / 2] );
+	}
+	sum[0] = sum2[0] = 0.;
+	for( i = 0; i < n; i++ ) {
+		sum[i + 1] = sum[i] + y[i];
+		sum2[i + 1] = sum2[i] + y[i] * y[i];
+	}
+	split_segments( sum, sum2, 0, n - 1, is_split );
+	is_split[n] = 1;
+
+	long int first = 0;
+	for( i = 1; i <= n; i++ ) {
+		if( !is_split[i] )
+			continue;
+		if( loglog_slope( first, i - 1 ) <= LEVEL_MAX_SLOPE && num_levels < max_levels ) {
+			levels[num_levels].first = first;
+			levels[num_levels].last = i - 1;
+			levels[num_levels].ticks = median_points( first, i - 1, 0 );
+			levels[num_levels].ns = median_points( first, i - 1, 1 );
+			levels[num_levels].capacity = sweep_points[i - 1].size;
+			num_levels++;
+		}
+		first = i;
+	}
+	/* the sweep ends on the last plateau, which therefore has no known capacity */
+	if( num_levels > 0 && levels[num_levels - 1].last == n - 1 )
+		levels[num_levels - 1].capacity = 0;
+
+	free( y ); free( sum ); free( sum2 ); free( is_split );
+	return num_levels;
+}
+
+/**
+ * Attribute of the data or unified cache of the given level of CPU 0 from
+ * sysfs, values with a K, M or G suffix are converted to Byte.
+ * @return value of the attribute, 0 if not available
+ */
+long int sysfs_cache_attr(int level, const char *attr){
+	char path[256], buf[64];
+	int index;
+
+	for( index = 0; index < 16; index++ ) {
+		long int size;
+		char unit = 0;
+		snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", index);
+		if( read_sysfs(path, buf, sizeof(buf)) != 0 )
+			break;
+		if( atoi(buf) != level )
+			continue;
+		snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", index);
+		if( read_sysfs(path, buf, sizeof(buf)) != 0 || strncmp(buf, "Instruction", 11) == 0 )
+			continue;
+		snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/%s", index, attr);
+		if( read_sysfs(path, buf, sizeof(buf)) != 0 || sscanf(buf, "%ld%c", &size, &unit) < 1 )
+			continue;
+		if( unit == 'K' )
+			size <<= 10;
+		else if( unit == 'M' )
+			size <<= 20;
+		else if( unit == 'G' )
+			size <<= 30;
+		return size;
+	}
+	return 0;
+}
+
+/**
+ * Size of the data or unified cache of the given level of CPU 0 from sysfs.
+ * @return size in Byte, 0 if not available
+ */
+long int sysfs_cache_size(int level){
+	return sysfs_cache_attr( level, "size" );
+}
+
+/**
+ * Detect the cache levels of the current sweep and report them in the log
+ * file and as machine readable table on stdout. A capacity of 0 marks the
+ * last level which is not bounded within the sweep, i.e. main memory if
+ * the sweep exceeds the last level cache.
+ */
+void report_levels(const char *pattern, const char *kernel_name){
+	cache_level levels[MAX_CACHE_LEVELS];
+	int num_levels = detect_levels( levels, MAX_CACHE_LEVELS );
+	int l;
+
+	fprintf( logfile, "# Detected levels: %d\n", num_levels );
+	fprintf( logfile, "# %6s %12s %12s %10s %12s\n", "level", "capacity", "ticks/access", "ns/access", "sysfs size" );
+	for( l = 0; l < num_levels; l++ ) {
+		char name[16];
+		long int sysfs_size = sysfs_cache_size( l + 1 );
+		snprintf( name, sizeof(name), "L%d", l + 1 );
+		fprintf( logfile, "# %6s %12ld %12.1lf %10.2lf %12ld\n", name, levels[l].capacity, levels[l].ticks, levels[l].ns, sysfs_size );
+		fprintf( stdout, "%s %s %ld %d %s %ld %.1lf %.2lf %ld\n", pattern, kernel_name, elem_size, num_chains,
+		         name, levels[l].capacity, levels[l].ticks, levels[l].ns, sysfs_size );
+	}
+	fflush( stdout );
+}
+
+void result_head();
+
+/**
+ * Summarize the bandwidth sweep in sweep_points per cache level from sysfs,
+ * as median over the working sets from the capacity of the level above to
+ * half the capacity of the level, and over those beyond twice the last
+ * level cache for main memory. Written to the log file and as machine
+ * readable table on stdout.
+ */
+void report_bw_levels(const char *kernel_name){
+	long int lower = 0, upper, first, last;
+	int l, num_levels = 0;
+
+	fprintf( logfile, "# Bandwidth per level\n" );
+	fprintf( logfile, "# %6s %12s %12s %10s %10s %6s\n", "level", "from", "to", "GB/s", "ticks/Byte", "points" );
+	for( l = 1; l <= MAX_CACHE_LEVELS + 1; l++ ) {
+		char name[16];
+		long int capacity = (l <= MAX_CACHE_LEVELS) ? sysfs_cache_size( l ) : 0;
+		if( capacity > 0 ) {
+			snprintf( name, sizeof(name), "L%d", l );
+			upper = capacity / 2;
+		}
+		else if( num_levels > 0 ) {
+			/* main memory after the last cache level */
+			snprintf( name, sizeof(name), "memory" );
+			lower *= 2;
+			upper = LONG_MAX;
+			l = MAX_CACHE_LEVELS + 1;
+		}
+		else
+			continue;
+		for( first = 0; first < num_sweep_points && sweep_points[first].size <= lower; first++ )
+			;
+		for( last = first; last < num_sweep_points && sweep_points[last].size <= upper; last++ )
+			;
+		if( capacity > 0 ) {
+			lower = capacity;
+			num_levels++;
+		}
+		if( last == first )
+			continue;
+		double ns = median_points( first, last - 1, 1 ), ticks = median_points( first, last - 1, 0 );
+		fprintf( logfile, "# %6s %12ld %12ld %10.2lf %10.3lf %6ld\n", name, sweep_points[first].size,
+		         sweep_points[last - 1].size, 1. / ns, ticks, last - first );
+		fprintf( stdout, "%s %s %ld %ld %.2lf %.3lf\n", kernel_name, name, sweep_points[first].size,
+		         sweep_points[last - 1].size, 1. / ns, ticks );
+	}
+	fflush( stdout );
+}
+
+/***********************************************************************
+ * set conflict probing
+ ***********************************************************************/
+/* largest number of aliasing elements of the conflict probe */
+#ifndef MAX_CONFLICT_WAYS
+#define MAX_CONFLICT_WAYS 64
+#endif
+
+/* minimum relative latency increase over the current plateau which marks
+ * a way conflict */
+#ifndef CONFLICT_MIN_STEP
+#define CONFLICT_MIN_STEP 0.3
+#endif
+
+#ifndef MAX_CONFLICT_STRIDES
+#define MAX_CONFLICT_STRIDES 16
+#endif
+
+/* distances between the aliasing elements, one probe per entry */
+long int conflict_strides[MAX_CONFLICT_STRIDES];
+int num_conflict_strides = 0;
+
+/* distance between the aliasing elements of the running probe */
+long int conflict_stride = 4096;
+
+/** way conflict detected in a conflict probe */
+typedef struct {
+	long int ways;       /**< largest number of elements before the conflict */
+	double ticks_before; /**< ticks per access on the plateau before */
+	double ticks_after;  /**< ticks per access after the conflict */
+	double ns_before, ns_after;
+} way_conflict;
+
+/**
+ * Build a chain of size / conflict_stride elements placed exactly
+ * conflict_stride Byte apart, so that all of them map to the same set of
+ * each cache whose set aliasing distance divides conflict_stride. The
+ * elements are visited in random order to keep the stride prefetchers out.
+ * @return wsetptr, NULL if wsetptr is NULL or in case of an error
+ */
+list_elem * init_conflict(list_elem *wsetptr, long int size){
+	long int i, n = size / conflict_stride;
+	long int *perm;
+
+	if( wsetptr == NULL )
+		return NULL;
+	perm = random_successors( n, random_seed ^ ((uint64_t) n * 0x9e3779b97f4a7c15ULL) );
+	if( perm == NULL )
+		return NULL;
+	for( i = 0; i < n; i++ )
+		((list_elem *) ((char *) wsetptr + i * conflict_stride))->next = (list_elem *) ((char *) wsetptr + perm[i] * conflict_stride);
+	free( perm );
+
+	return wsetptr;
+}
+
+/**
+ * Set aliasing distance, i.e. number of sets times line size, of the cache
+ * of the given level from sysfs rounded up to a power of two.
+ * @return distance in Byte, 0 if not available
+ */
+static long int aliasing_distance(int level){
+	long int dist = sysfs_cache_attr( level, "number_of_sets" ) * sysfs_cache_attr( level, "coherency_line_size" );
+	long int pow2 = CACHE_LINE_SIZE;
+
+	if( dist <= 0 )
+		return 0;
+	while( pow2 < dist )
+		pow2 *= 2;
+	return pow2;
+}
+
+/**
+ * Parse a comma separated list of power of two strides into
+ * conflict_strides. Without a list the aliasing distances of all cache
+ * levels are used, or 4K, 64K and 1M if sysfs does not provide them.
+ * @return number of strides, -1 in case of an invalid entry
+ */
+int parse_conflict_strides(const char *list){
+	char buf[1024];
+	char *ptr;
+	int n = 0, l;
+
+	if( list == NULL ) {
+		for( l = 1; l <= MAX_CACHE_LEVELS; l++ ) {
+			long int dist = aliasing_distance( l );
+			if( dist > 0 && (n == 0 || conflict_strides[n - 1] < dist) )
+				conflict_strides[n++] = dist;
+		}
+		if( n == 0 ) {
+			conflict_strides[n++] = 4096;
+			conflict_strides[n++] = 65536;
+			conflict_strides[n++] = 1048576;
+		}
+		return n;
+	}
+	strncpy(buf, list, sizeof(buf) - 1);
+	buf[sizeof(buf) - 1] = '\0';
+	for(ptr = strtok(buf, ","); ptr != NULL; ptr = strtok(NULL, ",")) {
+		long int stride = atol(ptr);
+		if(stride < CACHE_LINE_SIZE || (stride & (stride - 1)) != 0 || n == MAX_CONFLICT_STRIDES) {
+			fprintf(stderr, "ERROR: Invalid conflict stride '%s', has to be a power of two of at least %d Bytes (max. %d strides).\n", ptr, CACHE_LINE_SIZE, MAX_CONFLICT_STRIDES);
+			return -1;
+		}
+		conflict_strides[n++] = stride;
+	}
+	return n;
+}
+
+/**
+ * Median of the ticks (ns = 0) or ns (ns = 1) of up to three points
+ * starting at first.
+ */
+static double plateau_start(long int first, int ns){
+	double values[3];
+	long int i, n = (first + 3 <= num_sweep_points) ? 3 : num_sweep_points - first;
+
+	for( i = 0; i < n; i++ )
+		values[i] = ns ? sweep_points[first + i].ns : sweep_points[first + i].ticks;
+	qsort( values, n, sizeof(double), compare_double );
+	return values[(n - 1) / 2];
+}
+
+/**
+ * Detect the way conflicts of a conflict probe from the latencies in
+ * sweep_points, point i holds i + 1 aliasing elements. Starting with the
+ * latency of a single element, an element count at which the latency
+ * exceeds the current plateau by CONFLICT_MIN_STEP, confirmed by the next
+ * count, is a conflict. The count before it is the associativity of the
+ * level which overflowed. Counts over which the latency keeps rising by
+ * CONFLICT_MIN_STEP belong to the same conflict, the median of the points
+ * after them is the new plateau.
+ * @return number of detected conflicts
+ */
+int detect_conflicts(way_conflict *conflicts, int max_conflicts){
+	long int i, j;
+	int num_conflicts = 0;
+	double ticks, ns;
+
+	if( num_sweep_points == 0 )
+		return 0;
+	ticks = plateau_start( 0, 0 );
+	ns = plateau_start( 0, 1 );
+	for( i = 1; i + 1 < num_sweep_points && num_conflicts < max_conflicts; i++ ) {
+		double limit = ticks * (1. + CONFLICT_MIN_STEP);
+		if( sweep_points[i].ticks <= limit || sweep_points[i + 1].ticks <= limit )
+			continue;
+		/* the smaller of two neighbours is robust against a single outlier */
+		for( j = i; j + 2 < num_sweep_points; j++ ) {
+			double current = fmin( sweep_points[j].ticks, sweep_points[j + 1].ticks );
+			if( fmin( sweep_points[j + 1].ticks, sweep_points[j + 2].ticks ) <= current * (1. + CONFLICT_MIN_STEP) )
+				break;
+		}
+		conflicts[num_conflicts].ways = i;
+		conflicts[num_conflicts].ticks_before = ticks;
+		conflicts[num_conflicts].ns_before = ns;
+		conflicts[num_conflicts].ticks_after = ticks = plateau_start( j, 0 );
+		conflicts[num_conflicts].ns_after = ns = plateau_start( j, 1 );
+		num_conflicts++;
+		i = j + 1;
+	}
+	return num_conflicts;
+}
+
+/**
+ * Report the way conflicts of the conflict probe with the given stride in
+ * the log file and as machine readable table on stdout. The n-th conflict
+ * is attributed to the n-th cache level whose aliasing distance from sysfs
+ * divides the stride, since all elements share one set in exactly these
+ * levels and each level overflows once its ways are exhausted. Conflicts
+ * in set associative TLBs show up as additional steps, and physically
+ * indexed caches only alias reliably if the pages cover the stride.
+ */
+void report_conflicts(long int stride){
+	way_conflict conflicts[MAX_CACHE_LEVELS];
+	int num_conflicts = detect_conflicts( conflicts, MAX_CACHE_LEVELS );
+	int aliased[MAX_CACHE_LEVELS];
+	int num_aliased = 0, l, c;
+
+	for( l = 1; l <= MAX_CACHE_LEVELS; l++ ) {
+		long int dist = aliasing_distance( l );
+		if( dist > 0 && dist <= stride )
+			aliased[num_aliased++] = l;
+	}
+	fprintf( logfile, "# Way conflicts: %d\n", num_conflicts );
+	fprintf( logfile, "# %6s %6s %10s %12s %12s %12s %10s\n", "level", "ways", "sysfs ways", "ticks before", "ticks after", "penalty ticks", "penalty ns" );
+	for( c = 0; c < num_conflicts; c++ ) {
+		char name[16] = "-";
+		long int sysfs_ways = 0;
+		if( c < num_aliased ) {
+			snprintf( name, sizeof(name), "L%d", aliased[c] );
+			sysfs_ways = sysfs_cache_attr( aliased[c], "ways_of_associativity" );
+		}
+		double penalty_ticks = conflicts[c].ticks_after - conflicts[c].ticks_before;
+		double penalty_ns = conflicts[c].ns_after - conflicts[c].ns_before;
+		fprintf( logfile, "# %6s %6ld %10ld %12.1lf %12.1lf %12.1lf %10.2lf\n", name, conflicts[c].ways, sysfs_ways,
+		         conflicts[c].ticks_before, conflicts[c].ticks_after, penalty_ticks, penalty_ns );
+		fprintf( stdout, "%ld %ld %s %ld %ld %.1lf %.2lf\n", elem_size, stride, name, conflicts[c].ways, sysfs_ways,
+		         penalty_ticks, penalty_ns );
+	}
+	fflush( stdout );
+}
+
+/**
+ * Probe the associativity of the caches. For every stride of
+ * conflict_strides the number of elements placed one stride apart is raised
+ * from one up to MAX_CONFLICT_WAYS, limited by wset_final_size, and the
+ * random chase latency is measured for each count in the arena.
+ * @return sum of the test results
+ */
+long int conflict_probe(){
+	static char pattern[64];
+	long int result = 0;
+	int s;
+
+	for( s = 0; s < num_conflict_strides; s++ ) {
+		long int stride = conflict_stride = conflict_strides[s];
+		long int n, max_n = wset_final_size / stride;
+
+		if( max_n > MAX_CONFLICT_WAYS )
+			max_n = MAX_CONFLICT_WAYS;
+		if( max_n < 2 || stride < elem_size ) {
+			fprintf(stderr, "WARNING: Conflict stride %ld skipped, it needs an element size of at most the stride and a max. size of at least 2 strides.\n", stride);
+			continue;
+		}
+		snprintf( pattern, sizeof(pattern), "conflict-%ld", stride );
+
+		time_t starttime = time(NULL); /* calendar time */
+		fprintf( logfile, "# Starttime: %s", asctime( localtime(&starttime) ) );
+		fprintf( logfile, "# %s\n", pattern );
+		fprintf( logfile, "# Kernel: read\n" );
+		fprintf( logfile, "# Element size: %ld Bytes\n", elem_size );
+		if( stride > sysconf(_SC_PAGESIZE) && alloc_policy != ALLOC_HUGE_2M && alloc_policy != ALLOC_HUGE_1G && alloc_policy != ALLOC_THP )
+			fprintf( logfile, "# Note: strides above the page size alias in physically indexed caches only with huge pages (-a hugetlb-2M, thp)\n" );
+		result_head();
+		row_test = "conflict";
+		row_pattern = pattern;
+		row_kernel = "read";
+		num_sweep_points = 0;
+		for( n = 1; n <= max_n; n++ ) {
+			list_elem *wsetptr = init_conflict( (list_elem *) arena, n * stride );
+			if( wsetptr == NULL )
+				exit(1);
+			chain_length = n;
+			result += test_chase( n * stride, wsetptr, chase_read );
+		}
+		report_conflicts( stride );
+		time_t endtime = time(NULL); /* calendar time */
+		fprintf( logfile, "# Endtime: %s", asctime( localtime(&endtime) ) );
+		fprintf( logfile, "# Duration: %lf sec\n\n\n", difftime(endtime, starttime) );
+	}
+	return result;
+}
+
+/***********************************************************************
+ * hardware prefetcher characterization
+ ***********************************************************************/
+/* maximum latency of a prefetched stride relative to the random chase,
+ * strides above it have fallen back to the random level */
+#ifndef PREFETCH_MAX_RATIO
+#define PREFETCH_MAX_RATIO 0.8
+#endif
+
+#ifndef MAX_PREFETCH_STRIDES
+#define MAX_PREFETCH_STRIDES 32
+#endif
+
+/* strides in Byte of the prefetcher study */
+long int prefetch_strides[MAX_PREFETCH_STRIDES];
+int num_prefetch_strides = 0;
+
+/**
+ * Parse a comma separated list of strides in Byte into prefetch_strides.
+ * Without a list the powers of two from one cache line to 16 KB are used.
+ * @return number of strides, -1 in case of an invalid entry
+ */
+int parse_prefetch_strides(const char *list){
+	char buf[1024];
+	char *ptr;
+	int n = 0;
+
+	if( list == NULL ) {
+		long int stride;
+		for( stride = CACHE_LINE_SIZE; stride <= 16384; stride *= 2 )
+			prefetch_strides[n++] = stride;
+		return n;
+	}
+	strncpy(buf, list, sizeof(buf) - 1);
+	buf[sizeof(buf) - 1] = '\0';
+	for(ptr = strtok(buf, ","); ptr != NULL; ptr = strtok(NULL, ",")) {
+		long int stride = atol(ptr);
+		if(stride < (long) sizeof(list_elem) || stride % sizeof(list_elem) != 0 || n == MAX_PREFETCH_STRIDES) {
+			fprintf(stderr, "ERROR: Invalid prefetch stride '%s', has to be a multiple of %ld Bytes (max. %d strides).\n", ptr, sizeof(list_elem), MAX_PREFETCH_STRIDES);
+			return -1;
+		}
+		prefetch_strides[n++] = stride;
+	}
+	return n;
+}
+
+/**
+ * Time the read chase of one pattern on wset_final_size Byte of the arena
+ * with the current wset_stride and write one result line.
+ * @return ticks per access
+ */
+static double prefetch_point(init_fct_ptr init, long int *result){
+	long int size = wset_final_size;
+	list_elem *wsetptr = init( (list_elem *) arena, size );
+
+	if( wsetptr == NULL )
+		exit(1);
+	chain_length = size / (elem_size * wset_stride);
+	*result += test_chase( size, wsetptr, chase_read );
+	return sweep_points[num_sweep_points - 1].ticks;
+}
+
+/**
+ * Characterize the hardware prefetchers. The read chase is timed on
+ * wset_final_size Byte for every stride of prefetch_strides, traversed
+ * forward, backward and sequentially within randomly ordered pages
+ * (page-shuffled). Each is compared to a random chase over the same
+ * elements, which has the same cache and TLB footprint but cannot be
+ * prefetched. A stride counts as prefetched while its latency stays below
+ * PREFETCH_MAX_RATIO of the random one. The first stride above it is
+ * reported as the point where the prefetcher falls back to random latency.
+ * The log gets a summary table and stdout one line per variant and stride.
+ * @return sum of the test results
+ */
+long int prefetcher_study(){
+	static const struct {
+		const char *name;
+		init_fct_ptr init;
+	} variants[] = {
+		{"random", init_random}, /* reference, has to be the first */
+		{"forward", init_sequential},
+		{"backward", init_inverse_sequential},
+		{"page-shuffled", init_page_shuffled}
+	};
+	const int num_variants = sizeof(variants)/sizeof(variants[0]);
+	double ticks[sizeof(variants)/sizeof(variants[0])][MAX_PREFETCH_STRIDES];
+	long int saved_stride = wset_stride, result = 0;
+	int v, s;
+
+	time_t starttime = time(NULL); /* calendar time */
+	fprintf( logfile, "# Starttime: %s", asctime( localtime(&starttime) ) );
+	fprintf( logfile, "# prefetcher study\n" );
+	fprintf( logfile, "# Kernel: read\n" );
+	fprintf( logfile, "# Element size: %ld Bytes\n", elem_size );
+	row_test = "prefetch";
+	row_kernel = "read";
+	num_sweep_points = 0;
+
+	for( v = 0; v < num_variants; v++ ) {
+		fprintf( logfile, "# %s\n", variants[v].name );
+		result_head();
+		row_pattern = variants[v].name;
+		for( s = 0; s < num_prefetch_strides; s++ ) {
+			ticks[v][s] = NAN;
+			if( prefetch_strides[s] % elem_size != 0 || prefetch_strides[s] > wset_final_size / 2 ) {
+				fprintf(stderr, "WARNING: Prefetch stride %ld skipped, it has to be a multiple of the element size and at most half the max. size.\n", prefetch_strides[s]);
+				continue;
+			}
+			wset_stride = prefetch_strides[s] / elem_size;
+			ticks[v][s] = prefetch_point( variants[v].init, &result );
+		}
+	}
+	wset_stride = saved_stride;
+
+	fprintf( logfile, "# %14s %10s %12s %10s %10s\n", "variant", "stride", "ticks/access", "ns/access", "vs random" );
+	for( v = 1; v < num_variants; v++ ) {
+		long int fallback = 0;
+		for( s = 0; s < num_prefetch_strides; s++ ) {
+			double ratio = ticks[v][s] / ticks[0][s];
+			int prefetched = (ratio <= PREFETCH_MAX_RATIO);
+			if( isnan( ratio ) )
+				continue;
+			if( !prefetched && fallback == 0 )
+				fallback = prefetch_strides[s];
+			fprintf( logfile, "# %14s %10ld %12.1lf %10.2lf %10.2lf%s\n", variants[v].name, prefetch_strides[s],
+			         ticks[v][s], ticks[v][s] / tsc_ghz, ratio, prefetched ? " prefetched" : "" );
+			fprintf( stdout, "%s %ld %ld %.1lf %.2lf %.2lf %d\n", variants[v].name, elem_size, prefetch_strides[s],
+			         ticks[v][s], ticks[v][s] / tsc_ghz, ratio, prefetched );
+		}
+		if( fallback > 0 )
+			fprintf( logfile, "# %s: random latency from a stride of %ld Bytes\n", variants[v].name, fallback );
+		else
+			fprintf( logfile, "# %s: all strides prefetched\n", variants[v].name );
+	}
+	fflush( stdout );
+	time_t endtime = time(NULL); /* calendar time */
+	fprintf( logfile, "# Endtime: %s", asctime( localtime(&endtime) ) );
+	fprintf( logfile, "# Duration: %lf sec\n\n\n", difftime(endtime, starttime) );
+	return result;
+}
+
+/***********************************************************************
+ * loaded latency
+ ***********************************************************************/
+/* Byte per array a load thread processes between two throttle delays */
+#ifndef LOAD_CHUNK_SIZE
+#define LOAD_CHUNK_SIZE (64 * 1024)
+#endif
+
+#ifndef MAX_LOAD_DELAYS
+#define MAX_LOAD_DELAYS 32
+#endif
+
+/* values of load_delay which are not a delay */
+#define LOAD_IDLE -1
+#define LOAD_STOP -2
+
+/* loaded latency runs: number of load threads, their streaming operation
+ * and the throttle delays in ticks after each chunk */
+int num_load_threads = 0;
+bw_op_t load_op = BW_READ;
+long int load_delays[MAX_LOAD_DELAYS] = { 0, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000 };
+int num_load_delays = 9;
+
+/* current throttle delay of all load threads, LOAD_IDLE or LOAD_STOP */
+volatile long int load_delay = LOAD_IDLE;
+
+/** per thread data of a load thread */
+typedef struct {
+	long int bytes __attribute__((aligned(CACHE_LINE_SIZE))); /**< Byte streamed so far */
+	int id;                     /**< thread number */
+	int cpu;                    /**< CPU the thread is pinned to */
+	int error;                  /**< buffer allocation failed */
+	double result;              /**< checksum of the kernel */
+	thread_gate *gate;          /**< opened once all load threads exist */
+	pthread_barrier_t *barrier; /**< signals the buffer is ready */
+} load_data;
+
+/**
+ * Parse a comma separated list of throttle delays in ticks into
+ * load_delays.
+ * @return number of delays, -1 in case of an invalid entry
+ */
+int parse_load_delays(const char *list){
+	char buf[1024];
+	char *ptr;
+	int n = 0;
+
+	strncpy(buf, list, sizeof(buf) - 1);
+	buf[sizeof(buf) - 1] = '\0';
+	for(ptr = strtok(buf, ","); ptr != NULL; ptr = strtok(NULL, ",")) {
+		long int delay = atol(ptr);
+		if(delay < 0 || n == MAX_LOAD_DELAYS) {
+			fprintf(stderr, "ERROR: Invalid load delay '%s', has to be at least 0 ticks (max. %d delays).\n", ptr, MAX_LOAD_DELAYS);
+			return -1;
+		}
+		load_delays[n++] = delay;
+	}
+	return n;
+}
+
+/**
+ * Stream load_op over a private buffer of wset_final_size Byte in chunks of
+ * LOAD_CHUNK_SIZE Byte per array and busy wait load_delay ticks after each
+ * chunk, until load_delay is LOAD_STOP. The thread idles while it is
+ * LOAD_IDLE. The buffer is initialized by the thread for first touch
+ * placement.
+ */
+static void * load_thread(void *arg){
+	load_data *ld = (load_data *) arg;
+	const int num_arrays = bw_op_arrays[load_op];
+	const long int chunk = LOAD_CHUNK_SIZE / sizeof(double);
+	long int n = wset_final_size / num_arrays / sizeof(double) / chunk * chunk;
+	long int size = n * num_arrays * sizeof(double) + 3 * CACHE_LINE_SIZE;
+	long int pos = 0, delay, i, a;
+	bw_fct_ptr kernel = bw_isas[bw_isa].kernels[load_op][bw_nt];
+	double *arrays[3];
+	cpu_set_t cpuset;
+	char *mem = NULL;
+	int state;
+
+	/* the barrier counts all load threads, so it is only entered once all exist */
+	pthread_mutex_lock( &ld->gate->lock );
+	while( (state = ld->gate->state) == 0 )
+		pthread_cond_wait( &ld->gate->cond, &ld->gate->lock );
+	pthread_mutex_unlock( &ld->gate->lock );
+	if( state < 0 )
+		return NULL;
+
+	CPU_ZERO(&cpuset);
+	CPU_SET(ld->cpu, &cpuset);
+	if( pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0 ) {
+		fprintf(stderr, "WARNING: Could not pin load thread %d to CPU %d\n", ld->id, ld->cpu);
+	}
+	if( n > 0 )
+		mem = (char *) alloc_wset( size );
+	ld->error = (mem == NULL);
+	if( mem != NULL ) {
+		/* aligned to cache lines like the arrays of test_bandwidth */
+		for( i = 0; i < 3; i++ ) {
+			a = (i < num_arrays) ? i : 0;
+			arrays[i] = (double *) (((uintptr_t) mem + a * (n * sizeof(double) + CACHE_LINE_SIZE) + CACHE_LINE_SIZE - 1)
+			                        / CACHE_LINE_SIZE * CACHE_LINE_SIZE);
+		}
+		for( a = 0; a < num_arrays; a++ )
+			for( i = 0; i < n; i++ )
+				arrays[a][i] = a;
+	}
+	ld->result = 0.;
+	pthread_barrier_wait( ld->barrier ); /* ready */
+
+	while( mem != NULL && (delay = __atomic_load_n( &load_delay, __ATOMIC_RELAXED )) != LOAD_STOP ) {
+		if( delay == LOAD_IDLE ) {
+			usleep( 100 );
+			continue;
+		}
+		ld->result += kernel( arrays[0] + pos, arrays[1] + pos, arrays[2] + pos, 3., chunk );
+		pos += chunk;
+		if( pos == n )
+			pos = 0;
+		__atomic_store_n( &ld->bytes, ld->bytes + chunk * num_arrays * (long) sizeof(double), __ATOMIC_RELAXED );
+		if( delay > 0 ) {
+			ticks start = tsc_begin();
+			while( tsc_begin() - start < delay )
+				;
+		}
+	}
+	free_wset( mem, size );
+	return NULL;
+}
+
+/** @return Byte streamed by all load threads so far */
+static long int load_bytes(const load_data *data){
+	long int bytes = 0;
+	int t;
+	for( t = 0; t < num_load_threads; t++ )
+		bytes += __atomic_load_n( &data[t].bytes, __ATOMIC_RELAXED );
+	return bytes;
+}
+
+/**
+ * Measure the latency of the random read chase while num_load_threads
+ * threads stream load_op with each of the load_delays, similar to the
+ * loaded latency of Intel's Memory Latency Checker. The chase runs on the
+ * first CPU of thread_cpus, the load threads on the following ones. One
+ * working set of half the size of each cache level from sysfs and, if it
+ * exceeds the last level cache, one of wset_final_size for main memory are
+ * measured, without load first and
+ * then from the first to the last delay. The chase is warm, so each point
+ * reflects its level, and the load bandwidth is taken over the timed chase.
+ * The log gets one latency-bandwidth curve per level, stdout one line per
+ * point.
+ * @return sum of the test results, -1 in case of an error
+ */
+long int loaded_latency(){
+	pthread_t threads[num_load_threads];
+	load_data data[num_load_threads];
+	pthread_barrier_t barrier;
+	thread_gate gate = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0 };
+	long int sizes[MAX_CACHE_LEVELS + 1];
+	char names[MAX_CACHE_LEVELS + 1][16];
+	long int result = 0, largest = 0, llc = 0;
+	int num_sizes = 0, l, t, d, num_created, error = 0;
+	cpu_set_t orig_cpuset, cpuset;
+	static char kernel_name[64];
+
+	for( l = 1; l <= MAX_CACHE_LEVELS; l++ ) {
+		long int size = sysfs_cache_size( l ) / 2;
+		if( 2 * size > llc )
+			llc = 2 * size;
+		if( size <= largest || size > wset_final_size )
+			continue;
+		sizes[num_sizes] = largest = size;
+		snprintf( names[num_sizes++], sizeof(names[0]), "L%d", l );
+	}
+	if( wset_final_size > llc ) {
+		sizes[num_sizes] = wset_final_size;
+		snprintf( names[num_sizes++], sizeof(names[0]), "memory" );
+	}
+
+	sched_getaffinity(0, sizeof(orig_cpuset), &orig_cpuset);
+	CPU_ZERO(&cpuset);
+	CPU_SET(thread_cpus[0], &cpuset);
+	if( sched_setaffinity(0, sizeof(cpuset), &cpuset) != 0 )
+		fprintf(stderr, "WARNING: Could not pin the latency thread to CPU %d\n", thread_cpus[0]);
+	load_delay = LOAD_IDLE;
+	pthread_barrier_init( &barrier, NULL, num_load_threads + 1 );
+	for( t = 0; t < num_load_threads; t++ ) {
+		data[t].bytes = 0;
+		data[t].id = t;
+		data[t].cpu = thread_cpus[(t + 1) % num_thread_cpus];
+		data[t].gate = &gate;
+		data[t].barrier = &barrier;
+		if( pthread_create( &threads[t], NULL, load_thread, &data[t] ) != 0 )
+			break;
+	}
+	num_created = t;
+	pthread_mutex_lock( &gate.lock );
+	gate.state = (num_created == num_load_threads) ? 1 : -1;
+	pthread_cond_broadcast( &gate.cond );
+	pthread_mutex_unlock( &gate.lock );
+	if( num_created < num_load_threads ) {
+		fprintf(stderr, "ERROR: Could not create load thread %d of %d.\n", num_created, num_load_threads);
+		for( t = 0; t < num_created; t++ )
+			pthread_join( threads[t], NULL );
+		pthread_barrier_destroy( &barrier );
+		sched_setaffinity(0, sizeof(orig_cpuset), &orig_cpuset);
+		return -1;
+	}
+	pthread_barrier_wait( &barrier ); /* all buffers ready */
+	for( t = 0; t < num_load_threads; t++ )
+		error |= data[t].error;
+
+	row_test = "loaded";
+	row_pattern = "random";
+	row_kernel = kernel_name;
+	for( l = 0; l < num_sizes && !error; l++ ) {
+		long int size = sizes[l];
+		list_elem *lptr = init_random( (list_elem *) arena, size );
+
+		fprintf( logfile, "# loaded latency %s, load: %d threads %s\n", names[l], num_load_threads, bw_op_names[load_op] );
+		fprintf( logfile, "# %10s %10s %10s %12s %10s %10s\n", "size", "delay", "etime", "ticks/access", "ns/access", "load GB/s" );
+		chain_length = size / pattern_spacing( init_random );
+		for( d = -1; d < num_load_delays; d++ ) {
+			long int num_accesses, bytes;
+			double start, etime, ovh_ticks, ovh_sec, tick_latency, bandwidth;
+			ticks ticks1, ticks2;
+
+			load_delay = (d < 0) ? LOAD_IDLE : load_delays[d];
+			if( d < 0 )
+				snprintf( kernel_name, sizeof(kernel_name), "read-unloaded" );
+			else
+				snprintf( kernel_name, sizeof(kernel_name), "read-load-%s-%ld", bw_op_names[load_op], load_delays[d] );
+			num_accesses = calibrate_accesses( &lptr, chase_read, NUM_ACCESS_FACTOR * chain_length );
+			measure_overhead( lptr, chase_read, &ovh_ticks, &ovh_sec );
+			lptr = chase_read( lptr, chain_length );
+
+			bytes = load_bytes( data );
+			start = timer();
+			ticks1 = tsc_begin();
+			lptr = chase_read( lptr, num_accesses );
+			ticks2 = tsc_end();
+			etime = timer() - start;
+			bytes = load_bytes( data ) - bytes;
+			tick_latency = (ticks2 - ticks1 - ovh_ticks) / num_accesses;
+			bandwidth = bytes / etime / 1e9;
+			result += (long) lptr;
+
+			if( d < 0 )
+				fprintf( logfile, "%12ld %10s %10.6lf %12.1lf %10.2lf %10.2lf\n", size, "-", etime, tick_latency, tick_latency / tsc_ghz, bandwidth );
+			else
+				fprintf( logfile, "%12ld %10ld %10.6lf %12.1lf %10.2lf %10.2lf\n", size, load_delays[d], etime, tick_latency, tick_latency / tsc_ghz, bandwidth );
+			fprintf( stdout, "%s %ld %ld %.2lf %.1lf %.2lf\n", names[l], size, (d < 0) ? -1 : load_delays[d],
+			         bandwidth, tick_latency, tick_latency / tsc_ghz );
+			result_row row = { size, etime, tick_latency, tick_latency / tsc_ghz, NAN, bandwidth, NULL, NULL, -1, -1 };
+			report_row( &row );
+		}
+		fprintf( logfile, "\n\n" );
+		fflush( logfile );
+		fflush( stdout );
+	}
+
+	load_delay = LOAD_STOP;
+	for( t = 0; t < num_load_threads; t++ ) {
+		pthread_join( threads[t], NULL );
+		result += (long) data[t].result;
+	}
+	pthread_barrier_destroy( &barrier );
+	sched_setaffinity(0, sizeof(orig_cpuset), &orig_cpuset);
+	return error ? -1 : result;
+}
+
+/**
+ * Check whether name is contained in the comma separated list or the list
+ * contains the keyword "all".
+ */
+int name_in_list(const char *name, const char *list){
+	char buf[1024];
+	char *ptr;
+
+	strncpy(buf, list, sizeof(buf) - 1);
+	buf[sizeof(buf) - 1] = '\0';
+	for(ptr = strtok(buf, ","); ptr != NULL; ptr = strtok(NULL, ",")) {
+		if(strcmp(ptr, "all") == 0 || strcmp(ptr, name) == 0)
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * Parse a comma separated list of element sizes into elem_sizes.
+ * @return number of parsed element sizes, -1 in case of an invalid entry
+ */
+int parse_elem_sizes(const char *list){
+	char buf[1024];
+	char *ptr;
+	int n = 0;
+
+	strncpy(buf, list, sizeof(buf) - 1);
+	buf[sizeof(buf) - 1] = '\0';
+	for(ptr = strtok(buf, ","); ptr != NULL; ptr = strtok(NULL, ",")) {
+		long int esize = atol(ptr);
+		/* elements must hold the next pointer and keep it aligned */
+		if(esize < (long) sizeof(list_elem) || esize % sizeof(list_elem) != 0 || n == MAX_ELEM_SIZES) {
+			fprintf(stderr, "ERROR: Invalid element size '%s', has to be a multiple of %ld Bytes (max. %d sizes).\n", ptr, sizeof(list_elem), MAX_ELEM_SIZES);
+			return -1;
+		}
+		elem_sizes[n++] = esize;
+	}
+	return n;
+}
+
+/**
+ * @return working set size following size in a sweep
+ */
+long int next_size(long int size){
+	if(size < SMALL_ARRAY_LIMIT) {
+		return size + elem_size;
+	}
+	return size * factor;
+	//return (size + elem_size > size * factor) ? size + elem_size : size * factor;
+}
+
+/**
+ * Working set size of the pattern init for a sweep at size Byte. The page
+ * patterns only change with the number of pages, so their sizes are
+ * rounded up to whole pages and neighbouring sizes are not measured twice.
+ */
+long int pattern_size(init_fct_ptr init, long int size){
+	if( init == init_page_sequential || init == init_page_random )
+		return (size + page_stride - 1) / page_stride * page_stride;
+	return size;
+}
+
+/**
+ * Run the test for one working set size and store the ticks per access
+ * measured by it in ticks, NAN if the test recorded no point.
+ * @return test result
+ */
+long int sweep_size(long int size, init_fct_ptr init, test_fct_ptr test, chase_fct_ptr (*kernel)(), double *ticks){
+	list_elem *wsetptr;
+	long int points = num_sweep_points;
+	long int result;
+
+	chain_length = size / pattern_spacing( init );
+	if( num_threads > 0 ) {
+		result = test_threads( size, init, kernel() );
+		if( result == -1 )
+			exit(1);
+	}
+	else {
+		wsetptr = init( (list_elem *) arena, size );
+		if( wsetptr == NULL )
+			exit(1);
+		result = test( size, wsetptr );
+	}
+	*ticks = (num_sweep_points > points) ? sweep_points[num_sweep_points - 1].ticks : NAN;
+	return result;
+}
+
+/**
+ * Size of step k of the grid of the adaptive sweep, factor^k rounded up to
+ * whole elements and to the sizes of the pattern init. The grid does not
+ * depend on the measurements, so repeated runs measure the same sizes.
+ */
+long int grid_size(init_fct_ptr init, long int k){
+	long int size = (long int) ceil( pow( factor, k ) );
+	return pattern_size( init, (size + elem_size - 1) / elem_size * elem_size );
+}
+
+/** log rows and structured output of one point of an adaptive sweep */
+typedef struct {
+	long int size;
+	char *log, *out;
+	size_t log_len, out_len;
+} buffered_point;
+
+buffered_point *buffered_points = NULL;
+long int num_buffered_points = 0;
+long int max_buffered_points = 0;
+
+int compare_buffered_point(const void *a, const void *b){
+	long int x = ((const buffered_point *) a)->size, y = ((const buffered_point *) b)->size;
+	return (x > y) - (x < y);
+}
+
+/**
+ * Run sweep_size with the log file and the structured output written to
+ * memory, so that write_buffered_points can order the rows by size.
+ * @return test result
+ */
+long int buffered_size(long int size, init_fct_ptr init, test_fct_ptr test, chase_fct_ptr (*kernel)(), double *ticks){
+	FILE *log = logfile, *out = outfile;
+	buffered_point *pt;
+	long int result;
+
+	if( num_buffered_points == max_buffered_points ) {
+		long int max = max_buffered_points ? 2 * max_buffered_points : 64;
+		buffered_point *points = realloc( buffered_points, max * sizeof(buffered_point) );
+		if( points == NULL ) {
+			fprintf(stderr, "ERROR: Could not buffer the rows of the adaptive sweep.\n");
+			exit(1);
+		}
+		buffered_points = points;
+		max_buffered_points = max;
+	}
+	pt = &buffered_points[num_buffered_points];
+	pt->size = size;
+	pt->log = pt->out = NULL;
+	pt->log_len = pt->out_len = 0;
+	logfile = open_memstream( &pt->log, &pt->log_len );
+	if( out != NULL )
+		outfile = open_memstream( &pt->out, &pt->out_len );
+	if( logfile == NULL || (out != NULL && outfile == NULL) ) {
+		fprintf(stderr, "ERROR: Could not buffer the rows of the adaptive sweep: %s\n", strerror(errno));
+		exit(1);
+	}
+	result = sweep_size( size, init, test, kernel, ticks );
+	fclose( logfile );
+	if( out != NULL )
+		fclose( outfile );
+	logfile = log;
+	outfile = out;
+	num_buffered_points++;
+	return result;
+}
+
+/**
+ * Write the buffered points in the order of size and release them. rows is
+ * the number of structured rows written before the sweep, the JSON
+ * separators follow the written order instead of the measured one.
+ */
+void write_buffered_points(long int rows){
+	long int i;
+
+	qsort( buffered_points, num_buffered_points, sizeof(buffered_point), compare_buffered_point );
+	for( i = 0; i < num_buffered_points; i++ ) {
+		buffered_point *pt = &buffered_points[i];
+		fwrite( pt->log, 1, pt->log_len, logfile );
+		if( outfile != NULL && pt->out_len > 0 ) {
+			size_t skip = 0;
+			if( output_format == FORMAT_JSON ) {
+				skip = (pt->out[0] == ',');
+				fprintf( outfile, "%s", rows ? "," : "" );
+			}
+			fwrite( pt->out + skip, 1, pt->out_len - skip, outfile );
+			rows++;
+		}
+		free( pt->log );
+		free( pt->out );
+	}
+	num_buffered_points = 0;
+	fflush( logfile );
+	if( outfile != NULL )
+		fflush( outfile );
+}
+
+/**
+ * Bisect the interval between the measured grid steps klo and khi while the
+ * latency changes by more than adaptive_threshold and a step lies between
+ * them. Steps rounded to the size of a bound are skipped.
+ * @return sum of the test results
+ */
+long int refine_interval(long int klo, double ticks_lo, long int khi, double ticks_hi,
+                         init_fct_ptr init, test_fct_ptr test, chase_fct_ptr (*kernel)()){
+	long int mid = (klo + khi) / 2, size;
+	long int result;
+	double ticks_mid;
+
+	if( khi - klo < 2 )
+		return 0;
+	/* intervals with a failed measurement are not refined */
+	if( !(fabs( log( ticks_hi / ticks_lo ) ) > log( 1. + adaptive_threshold )) )
+		return 0;
+	size = grid_size( init, mid );
+	if( size == grid_size( init, klo ) )
+		return refine_interval( mid, ticks_lo, khi, ticks_hi, init, test, kernel );
+	if( size == grid_size( init, khi ) )
+		return refine_interval( klo, ticks_lo, mid, ticks_hi, init, test, kernel );
+	result = buffered_size( size, init, test, kernel, &ticks_mid );
+	result += refine_interval( klo, ticks_lo, mid, ticks_mid, init, test, kernel );
+	result += refine_interval( mid, ticks_mid, khi, ticks_hi, init, test, kernel );
+	return result;
+}
+
+/**
+ * Run the tests for all working set sizes with one pattern and kernel and
+ * write a section to the log file. With adaptive_threshold a coarse pass
+ * over a fixed grid of sizes is refined around the latency steps only, the
+ * rows are buffered and written in the order of size. Ranges too narrow for
+ * two grid steps are swept densely.
+ * @return sum of the test results
+ */
+long int sweep(const char *pattern, init_fct_ptr init, const char *kernel_name, test_fct_ptr test, chase_fct_ptr (*kernel)()){
+	long int size;
+	long int result = 0;
+	/* every chain needs at least one element */
+	long int min_size = pattern_spacing( init ) * num_chains;
+	long int k_first = 0, k_last = -1;
+
+	if( adaptive_threshold > 0. ) {
+		/* the grid steps from the start size up to the final size */
+		long int lo = (wset_start_size < min_size) ? min_size : wset_start_size;
+		k_first = (long int) floor( log( (double) lo ) / log( factor ) );
+		while( grid_size( init, k_first ) < lo )
+			k_first++;
+		k_last = (long int) ceil( log( (double) wset_final_size ) / log( factor ) );
+		while( k_last >= k_first && grid_size( init, k_last ) > wset_final_size )
+			k_last--;
+	}
+
+	time_t starttime = time(NULL); /* calendar time */
+	fprintf( logfile, "# Starttime: %s", asctime( localtime(&starttime) ) );
+	fprintf( logfile, "# %s\n", pattern );
+	fprintf( logfile, "# Kernel: %s\n", kernel_name );
+	fprintf( logfile, "# Element size: %ld Bytes\n", elem_size );
+	fprintf( logfile, "# Chains: %d\n", num_chains );
+	result_head();
+	row_test = "latency";
+	row_pattern = pattern;
+	row_kernel = kernel_name;
+	num_sweep_points = 0;
+	if( adaptive_threshold > 0. && k_first < k_last ) {
+		long int step = (long int) ceil( log( ADAPTIVE_COARSE_FACTOR ) / log( factor ) );
+		long int klo = k_first, khi, rows = num_rows;
+		double ticks_lo, ticks_hi;
+		result += buffered_size( grid_size( init, klo ), init, test, kernel, &ticks_lo );
+		for( ; klo < k_last; klo = khi, ticks_lo = ticks_hi ) {
+			khi = (klo + step < k_last) ? klo + step : k_last;
+			if( grid_size( init, khi ) == grid_size( init, klo ) ) {
+				ticks_hi = ticks_lo;
+				continue;
+			}
+			result += buffered_size( grid_size( init, khi ), init, test, kernel, &ticks_hi );
+			result += refine_interval( klo, ticks_lo, khi, ticks_hi, init, test, kernel );
+		}
+		write_buffered_points( rows );
+		/* the level detection expects the points in the order of size */
+		qsort( sweep_points, num_sweep_points, sizeof(sweep_point), compare_sweep_point );
+		fprintf( logfile, "# Points: %ld\n", num_sweep_points );
+	}
+	else {
+		for( size = pattern_size( init, (wset_start_size < min_size) ? min_size : wset_start_size ); size <= wset_final_size;
+		     size = pattern_size( init, next_size(size) ) ) {
+			double ticks;
+			result += sweep_size( size, init, test, kernel, &ticks );
+		}
+	}
+	fprintf( logfile, "# Result: %ld\n", result );
+	if( detect_cache_levels )
+		report_levels( pattern, kernel_name );
+	time_t endtime = time(NULL); /* calendar time */
+	fprintf( logfile, "# Endtime: %s", asctime( localtime(&endtime) ) );
+	fprintf( logfile, "# Duration: %lf sec\n\n\n", difftime(endtime, starttime) );
+	return result;
+}
+
+/***********************************************************************
+ * cache simulation
+ ***********************************************************************/
+#ifndef MAX_SIM_LEVELS
+#define MAX_SIM_LEVELS 4
+#endif
+
+/* addresses simulated at once, level by level */
+#ifndef SIM_BATCH
+#define SIM_BATCH 4096
+#endif
+
+/* walkers following the segments of a chain at once, so that their cache
+ * misses overlap, and chain elements per segment */
+#ifndef SIM_WALKERS
+#define SIM_WALKERS 16
+#endif
+#ifndef SIM_SEGMENT
+#define SIM_SEGMENT 4096
+#endif
+
+/* largest fraction 1/n of the cache sets simulated for large working sets */
+#ifndef SIM_MAX_SAMPLING
+#define SIM_MAX_SAMPLING 64
+#endif
+
+/* accesses per lap a sampled simulation keeps at least */
+#ifndef SIM_MIN_SAMPLED_ACCESSES
+#define SIM_MIN_SAMPLED_ACCESSES 16384
+#endif
+
+/* memory of the points simulated at the same time in Byte */
+#ifndef SIM_MEMORY_LIMIT
+#define SIM_MEMORY_LIMIT (1L << 30)
+#endif
+
+typedef enum { SIM_LRU, SIM_PLRU } sim_policy_t;
+const char *sim_policy_names[] = { "lru", "plru" };
+
+/** configuration of one simulated cache level */
+typedef struct {
+	long int size;       /**< capacity in Byte */
+	int ways;            /**< associativity */
+	int line;            /**< line size in Byte */
+	sim_policy_t policy; /**< replacement policy */
+	int inclusive;       /**< evictions invalidate the line in the levels above */
+} sim_level_config;
+
+sim_level_config sim_levels[MAX_SIM_LEVELS];
+int num_sim_levels = 0;
+
+/* names of the miss rate columns, chosen like the matching --events */
+char sim_event_names[MAX_SIM_LEVELS][16];
+
+/** state of one simulated cache level */
+typedef struct {
+	const sim_level_config *cfg;
+	long int sets;
+	long int sampling; /**< only every sampling-th set is stored */
+	uint64_t *tags;   /**< line number + 1 of each way, 0 marks an invalid way */
+	uint64_t *state;  /**< LRU: time of the last access of each way, PLRU: tree bits of each set */
+	uint64_t clock;
+	long int misses;
+} sim_cache;
+
+/* line size shared by all simulated levels */
+int sim_line = CACHE_LINE_SIZE;
+
+/**
+ * Parse the cache configuration of the simulation, a comma separated list
+ * of levels size:ways[:line][:lru|plru][:inclusive] starting at the first
+ * level, e.g. 32K:8,1M:16:plru,32M:16:inclusive. Sizes may carry a K, M
+ * or G suffix. Without a list the levels are taken from sysfs.
+ * @return number of levels, -1 in case of an invalid entry
+ */
+static int parse_sim_levels(const char *list){
+	char buf[1024];
+	char *level, *save_level;
+	int n = 0, l;
+
+	if( list == NULL ) {
+		for( l = 1; l <= MAX_CACHE_LEVELS && n < MAX_SIM_LEVELS; l++ ) {
+			long int size = sysfs_cache_size( l );
+			if( size <= 0 )
+				continue;
+			sim_levels[n].size = size;
+			sim_levels[n].ways = sysfs_cache_attr( l, "ways_of_associativity" );
+			sim_levels[n].line = sysfs_cache_attr( l, "coherency_line_size" );
+			sim_levels[n].policy = SIM_LRU;
+			sim_levels[n].inclusive = 0;
+			if( sim_levels[n].line <= 0 )
+				sim_levels[n].line = CACHE_LINE_SIZE;
+			if( sim_levels[n].ways <= 0 )
+				sim_levels[n].ways = 8;
+			n++;
+		}
+		if( n == 0 )
+			fprintf(stderr, "ERROR: No cache levels in sysfs, give the configuration with --simulate=size:ways,...\n");
+		return n ? n : -1;
+	}
+	strncpy(buf, list, sizeof(buf) - 1);
+	buf[sizeof(buf) - 1] = '\0';
+	for(level = strtok_r(buf, ",", &save_level); level != NULL; level = strtok_r(NULL, ",", &save_level)) {
+		char *field, *save_field, unit = 0;
+		sim_level_config *cfg = &sim_levels[n];
+		if(n == MAX_SIM_LEVELS) {
+			fprintf(stderr, "ERROR: At most %d cache levels can be simulated.\n", MAX_SIM_LEVELS);
+			return -1;
+		}
+		cfg->size = cfg->ways = 0;
+		cfg->line = CACHE_LINE_SIZE;
+		cfg->policy = SIM_LRU;
+		cfg->inclusive = 0;
+		field = strtok_r(level, ":", &save_field);
+		if(field != NULL && sscanf(field, "%ld%c", &cfg->size, &unit) >= 1)
+			cfg->size <<= (unit == 'K') ? 10 : (unit == 'M') ? 20 : (unit == 'G') ? 30 : 0;
+		field = strtok_r(NULL, ":", &save_field);
+		if(field != NULL)
+			cfg->ways = atoi(field);
+		while((field = strtok_r(NULL, ":", &save_field)) != NULL) {
+			if(strcmp(field, "lru") == 0)
+				cfg->policy = SIM_LRU;
+			else if(strcmp(field, "plru") == 0)
+				cfg->policy = SIM_PLRU;
+			else if(strcmp(field, "inclusive") == 0)
+				cfg->inclusive = 1;
+			else
+				cfg->line = atoi(field);
+		}
+		if(cfg->ways < 1 || cfg->ways > 64 || cfg->line < (int) sizeof(list_elem) || (cfg->line & (cfg->line - 1)) != 0
+		   || cfg->size < (long) cfg->ways * cfg->line || (cfg->policy == SIM_PLRU && (cfg->ways & (cfg->ways - 1)) != 0)) {
+			fprintf(stderr, "ERROR: Invalid cache level %d, needs size:ways with up to 64 ways, a power of two line size "
+			                "and for plru a power of two of ways.\n", n + 1);
+			return -1;
+		}
+		n++;
+	}
+	return n;
+}
+
+/**
+ * Parse the cache configuration of the simulation with parse_sim_levels.
+ * All levels have to share one line size, the simulation works on line
+ * numbers.
+ * @return number of levels, -1 in case of an invalid configuration
+ */
+int parse_sim_config(const char *list){
+	int n = parse_sim_levels( list ), l;
+
+	for( l = 1; l < n; l++ ) {
+		if( sim_levels[l].line != sim_levels[0].line ) {
+			fprintf(stderr, "ERROR: All simulated cache levels need the same line size.\n");
+			return -1;
+		}
+	}
+	if( n > 0 )
+		sim_line = sim_levels[0].line;
+	return n;
+}
+
+/**
+ * Name the miss rate columns of the simulation like the matching events,
+ * so that simulated and measured runs share their column names.
+ */
+void sim_events(){
+	int l;
+
+	for( l = 0; l < num_sim_levels; l++ ) {
+		if( l == 0 )
+			snprintf( sim_event_names[l], sizeof(sim_event_names[l]), "l1d-misses" );
+		else if( l == num_sim_levels - 1 )
+			snprintf( sim_event_names[l], sizeof(sim_event_names[l]), "llc-misses" );
+		else
+			snprintf( sim_event_names[l], sizeof(sim_event_names[l]), "l%d-misses", l + 1 );
+		events[l].name = sim_event_names[l];
+		events[l].type = PERF_TYPE_SOFTWARE;
+		events[l].config = 0;
+	}
+	num_events = num_sim_levels;
+}
+
+/**
+ * Set up the cache c for a simulation which only sees the lines of every
+ * sampling-th set.
+ * @return 0 on success, 1 if the cache could not be allocated
+ */
+static int sim_cache_init(sim_cache *c, const sim_level_config *cfg, long int sampling){
+	long int entries;
+
+	c->cfg = cfg;
+	c->sets = cfg->size / ((long) cfg->ways * cfg->line);
+	c->sampling = sampling;
+	c->clock = 0;
+	c->misses = 0;
+	entries = c->sets / sampling * cfg->ways;
+	c->tags = (uint64_t *) calloc( entries, sizeof(uint64_t) );
+	c->state = (uint64_t *) calloc( (cfg->policy == SIM_LRU) ? entries : c->sets / sampling, sizeof(uint64_t) );
+	return c->tags == NULL || c->state == NULL;
+}
+
+static void sim_cache_free(sim_cache *c){
+	free( c->tags );
+	free( c->state );
+}
+
+/** Mark way w of set as most recently used. */
+static inline void sim_touch(sim_cache *c, long int set, int w){
+	if( c->cfg->policy == SIM_LRU ) {
+		c->state[set * c->cfg->ways + w] = ++c->clock;
+	}
+	else {
+		/* tree bits of the nodes on the path point away from way w */
+		int node = 1, bit;
+		for( bit = __builtin_ctz( c->cfg->ways ) - 1; bit >= 0; bit-- ) {
+			int dir = (w >> bit) & 1;
+			if( dir )
+				c->state[set] &= ~(1ULL << node);
+			else
+				c->state[set] |= 1ULL << node;
+			node = 2 * node + dir;
+		}
+	}
+}
+
+/** @return way of set to be replaced */
+static inline int sim_victim(const sim_cache *c, long int set){
+	const uint64_t *tags = c->tags + set * c->cfg->ways;
+	int w, victim = 0;
+
+	for( w = 0; w < c->cfg->ways; w++ )
+		if( tags[w] == 0 )
+			return w;
+	if( c->cfg->policy == SIM_LRU ) {
+		const uint64_t *stamps = c->state + set * c->cfg->ways;
+		for( w = 1; w < c->cfg->ways; w++ )
+			if( stamps[w] < stamps[victim] )
+				victim = w;
+		return victim;
+	}
+	int node = 1;
+	while( node < c->cfg->ways )
+		node = 2 * node + ((c->state[set] >> node) & 1);
+	return node - c->cfg->ways;
+}
+
+/**
+ * Access the line with number line, which has to lie in a sampled set. On
+ * a miss the line is filled and a valid replaced line is stored in evicted.
+ * @return 1 on a hit, 0 on a miss
+ */
+static inline int sim_access(sim_cache *c, uint64_t line, uint64_t *evicted){
+	long int set = line % c->sets / c->sampling;
+	uint64_t *tags = c->tags + set * c->cfg->ways;
+	int w;
+
+	for( w = 0; w < c->cfg->ways; w++ ) {
+		if( tags[w] == line + 1 ) {
+			sim_touch( c, set, w );
+			return 1;
+		}
+	}
+	w = sim_victim( c, set );
+	*evicted = tags[w] ? tags[w] - 1 : UINT64_MAX;
+	tags[w] = line + 1;
+	sim_touch( c, set, w );
+	return 0;
+}
+
+/** Invalidate the line with number line. */
+static void sim_invalidate(sim_cache *c, uint64_t line){
+	uint64_t *tags = c->tags + (line % c->sets / c->sampling) * c->cfg->ways;
+	int w;
+
+	for( w = 0; w < c->cfg->ways; w++ )
+		if( tags[w] == line + 1 )
+			tags[w] = 0;
+}
+
+/**
+ * Run a batch of count line numbers through the hierarchy level by level,
+ * the misses of a level form the batch of the next one. Replaced lines of
+ * an inclusive level are invalidated in the levels above at the end of the
+ * batch. lines is overwritten.
+ */
+static void sim_batch(sim_cache *caches, uint64_t *lines, long int count){
+	uint64_t evicted[SIM_BATCH];
+	int l, k;
+
+	for( l = 0; l < num_sim_levels && count > 0; l++ ) {
+		long int i, misses = 0, num_evicted = 0;
+		for( i = 0; i < count; i++ ) {
+			uint64_t victim;
+			if( sim_access( &caches[l], lines[i], &victim ) )
+				continue;
+			lines[misses++] = lines[i];
+			if( caches[l].cfg->inclusive && victim != UINT64_MAX )
+				evicted[num_evicted++] = victim;
+		}
+		caches[l].misses += misses;
+		for( i = 0; i < num_evicted; i++ )
+			for( k = 0; k < l; k++ )
+				sim_invalidate( &caches[k], evicted[i] );
+		count = misses;
+	}
+}
+
+/**
+ * Largest power of two up to SIM_MAX_SAMPLING dividing the number of sets
+ * of all levels, so that the lines with a number multiple of it fill
+ * exactly every sampling-th set of each level. Chains with few accesses
+ * per lap are simulated completely.
+ */
+static long int sim_sampling(init_fct_ptr init, long int size){
+	long int sampling;
+	int l;
+
+	for( sampling = SIM_MAX_SAMPLING; sampling > 1; sampling /= 2 ) {
+		if( size / pattern_spacing( init ) / sampling < SIM_MIN_SAMPLED_ACCESSES )
+			continue;
+		for( l = 0; l < num_sim_levels; l++ )
+			if( (sim_levels[l].size / ((long) sim_levels[l].ways * sim_line)) % sampling != 0 )
+				break;
+		if( l == num_sim_levels )
+			break;
+	}
+	return sampling;
+}
+
+/** access order of one lap of a pattern as line numbers */
+typedef struct {
+	uint64_t *lines;
+	long int len, max;
+	long int sampling;
+} sim_lap;
+
+static int sim_append(sim_lap *lap, uint64_t line){
+	if( lap->len == lap->max ) {
+		long int max = lap->max ? 2 * lap->max : 1024;
+		uint64_t *lines = realloc( lap->lines, max * sizeof(uint64_t) );
+		if( lines == NULL )
+			return 1;
+		lap->lines = lines;
+		lap->max = max;
+	}
+	lap->lines[lap->len++] = line;
+	return 0;
+}
+
+/** piece of a chain from one marker to the element before the next one */
+typedef struct {
+	int walker;         /**< walker whose lap holds the accesses */
+	long int start;     /**< first access in that lap */
+	long int len;       /**< number of accesses */
+	long int next;      /**< following marker */
+} sim_segment;
+
+static int compare_ptr(const void *a, const void *b){
+	uintptr_t x = (uintptr_t) *(void * const *) a, y = (uintptr_t) *(void * const *) b;
+	return (x > y) - (x < y);
+}
+
+/**
+ * Build the chain of the pattern init on a private zeroed working set of
+ * size Byte with the same generator as the measurement and collect one lap
+ * of it as the line numbers of the sampled sets in access order. The non
+ * zero words of the working set are the next pointers of the chain, every
+ * SIM_SEGMENT-th of them is tagged in its low bit as marker. The segments
+ * between markers are walked by SIM_WALKERS walkers at once, whose cache
+ * misses overlap unlike those of a single traversal, and are joined in
+ * chain order from the marker at the start. The working set is released
+ * before the simulation.
+ * @return 0 on success, 1 if out of memory
+ */
+static int sim_pattern(init_fct_ptr init, long int size, sim_lap *lap){
+	char *base = (char *) calloc( size + elem_size, 1 );
+	list_elem *wsetptr = init( (list_elem *) base, size );
+	list_elem **markers = NULL, *pos[SIM_WALKERS];
+	sim_lap walks[SIM_WALKERS];
+	sim_segment *segments = NULL;
+	long int num_words = (size + elem_size) / sizeof(list_elem), num_markers = 0, max_markers = 0;
+	long int seg[SIM_WALKERS], next_marker = 0, count = 0, i;
+	int w, active = 0, error = 0;
+
+	for( w = 0; w < SIM_WALKERS; w++ ) {
+		walks[w].lines = NULL;
+		walks[w].len = walks[w].max = 0;
+		walks[w].sampling = lap->sampling;
+	}
+	if( wsetptr == NULL ) {
+		free( base );
+		return 1;
+	}
+	for( i = 0; i < num_words && !error; i++ ) {
+		list_elem *e = (list_elem *) base + i;
+		if( e->next == NULL || count++ % SIM_SEGMENT != 0 )
+			continue;
+		if( num_markers == max_markers ) {
+			long int max = max_markers ? 2 * max_markers : 1024;
+			list_elem **m = realloc( markers, max * sizeof(list_elem *) );
+			error = (m == NULL);
+			if( error )
+				break;
+			markers = m;
+			max_markers = max;
+		}
+		markers[num_markers++] = e;
+		e->next = (list_elem *) ((uintptr_t) e->next | 1);
+	}
+	segments = (sim_segment *) malloc( (num_markers + 1) * sizeof(sim_segment) );
+	error |= (segments == NULL);
+
+	for( w = 0; w < SIM_WALKERS && !error && next_marker < num_markers; w++, active++ ) {
+		seg[w] = next_marker++;
+		pos[w] = markers[seg[w]];
+		segments[seg[w]].walker = w;
+		segments[seg[w]].start = 0;
+	}
+	for( ; w < SIM_WALKERS; w++ )
+		pos[w] = NULL;
+	while( active > 0 && !error ) {
+		for( w = 0; w < SIM_WALKERS; w++ ) {
+			list_elem *e = pos[w], *next;
+			if( e == NULL )
+				continue;
+			uint64_t line = (uint64_t) ((char *) e - base) / sim_line;
+			if( line % lap->sampling == 0 && sim_append( &walks[w], line ) ) {
+				error = 1;
+				break;
+			}
+			next = (list_elem *) ((uintptr_t) e->next & ~(uintptr_t) 1);
+			if( !((uintptr_t) next->next & 1) ) {
+				pos[w] = next;
+				continue;
+			}
+			/* the segment ends before the next marker */
+			sim_segment *s = &segments[seg[w]];
+			list_elem **m = (list_elem **) bsearch( &next, markers, num_markers, sizeof(list_elem *), compare_ptr );
+			s->len = walks[w].len - s->start;
+			s->next = m - markers;
+			if( next_marker < num_markers ) {
+				seg[w] = next_marker++;
+				pos[w] = markers[seg[w]];
+				segments[seg[w]].walker = w;
+				segments[seg[w]].start = walks[w].len;
+			}
+			else {
+				pos[w] = NULL;
+				active--;
+			}
+		}
+	}
+	free( base );
+
+	/* join the segments in chain order, the first marker is the start */
+	for( count = 0, w = 0; w < SIM_WALKERS; w++ )
+		count += walks[w].len;
+	if( !error && count > 0 ) {
+		lap->lines = (uint64_t *) malloc( count * sizeof(uint64_t) );
+		error = (lap->lines == NULL);
+		lap->max = count;
+		for( i = 0, next_marker = 0; !error && next_marker < num_markers; next_marker++ ) {
+			sim_segment *s = &segments[i];
+			if( s->len > 0 )
+				memcpy( lap->lines + lap->len, walks[s->walker].lines + s->start, s->len * sizeof(uint64_t) );
+			lap->len += s->len;
+			i = s->next;
+		}
+	}
+	for( w = 0; w < SIM_WALKERS; w++ )
+		free( walks[w].lines );
+	free( markers );
+	free( segments );
+	return error;
+}
+
+/** @return whether the pattern init can be simulated, i.e. forms a chain */
+int sim_supported(init_fct_ptr init){
+	return init != init_trace && init != init_conflict;
+}
+
+/** one point of a simulated sweep */
+typedef struct {
+	long int size;
+	long int sampling;
+	long int memory;   /**< estimated memory of the simulation in Byte */
+	double miss_rates[MAX_SIM_LEVELS]; /**< misses per access of each level */
+	int error;
+} sim_point;
+
+/** work shared by the simulation threads */
+typedef struct {
+	init_fct_ptr init;
+	sim_point *points;
+	long int num_points;
+	long int next;       /**< next point to be taken by a thread */
+	long int memory;     /**< memory left for further points */
+	int running;         /**< points being simulated */
+	pthread_mutex_t lock;
+	pthread_cond_t done;
+} sim_work;
+
+/**
+ * Simulate one point: collect one lap of the chain and run it twice
+ * through a cold hierarchy, the first time untimed like the warm-up of a
+ * measurement and the second time counting the misses.
+ */
+static void sim_point_run(init_fct_ptr init, sim_point *pt){
+	sim_cache caches[MAX_SIM_LEVELS];
+	sim_lap lap = { NULL, 0, 0, pt->sampling };
+	uint64_t lines[SIM_BATCH];
+	long int i, n;
+	int l, lap_num, error;
+
+	error = sim_pattern( init, pt->size, &lap ) || lap.len == 0;
+	for( l = 0; l < num_sim_levels; l++ )
+		error |= sim_cache_init( &caches[l], &sim_levels[l], pt->sampling );
+	for( lap_num = 0; lap_num < 2 && !error; lap_num++ ) {
+		for( l = 0; l < num_sim_levels; l++ )
+			caches[l].misses = 0;
+		for( i = 0; i < lap.len; i += n ) {
+			n = (lap.len - i < SIM_BATCH) ? lap.len - i : SIM_BATCH;
+			memcpy( lines, lap.lines + i, n * sizeof(uint64_t) );
+			sim_batch( caches, lines, n );
+		}
+	}
+	for( l = 0; l < num_sim_levels; l++ ) {
+		if( !error )
+			pt->miss_rates[l] = (double) caches[l].misses / lap.len;
+		sim_cache_free( &caches[l] );
+	}
+	free( lap.lines );
+	pt->error = error;
+}
+
+/**
+ * Take points from work until all are done. A point waits until its memory
+ * estimate fits into what the running points leave of SIM_MEMORY_LIMIT,
+ * unless it is the only one.
+ */
+static void * sim_thread(void *arg){
+	sim_work *work = (sim_work *) arg;
+	long int i;
+
+	while( 1 ) {
+		pthread_mutex_lock( &work->lock );
+		i = work->next++;
+		if( i >= work->num_points ) {
+			pthread_mutex_unlock( &work->lock );
+			return NULL;
+		}
+		while( work->running > 0 && work->points[i].memory > work->memory )
+			pthread_cond_wait( &work->done, &work->lock );
+		work->memory -= work->points[i].memory;
+		work->running++;
+		pthread_mutex_unlock( &work->lock );
+
+		sim_point_run( work->init, &work->points[i] );
+
+		pthread_mutex_lock( &work->lock );
+		work->memory += work->points[i].memory;
+		work->running--;
+		pthread_cond_broadcast( &work->done );
+		pthread_mutex_unlock( &work->lock );
+	}
+}
+
+/**
+ * Predict the miss rates of the configured cache hierarchy for all working
+ * set sizes of a sweep of the pattern init with the read kernel. The access
+ * orders come from the chains of the init function, and large working sets
+ * only simulate a sample of the cache sets. The points are simulated in
+ * parallel, largest first, on up to MAX_INIT_THREADS threads within
+ * SIM_MEMORY_LIMIT, larger points run alone. The miss rates per access are written in the columns
+ * of the matching events, the measured columns stay empty.
+ * @return 0 on success, 1 otherwise
+ */
+int simulate_sweep(const char *pattern, init_fct_ptr init){
+	pthread_t threads[MAX_INIT_THREADS];
+	int started[MAX_INIT_THREADS];
+	long int num_threads_sim = sysconf(_SC_NPROCESSORS_ONLN), i, size;
+	long int min_size = pattern_spacing( init );
+	sim_work work = { init, NULL, 0, 0, SIM_MEMORY_LIMIT, 0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+	int t, l, error = 0;
+
+	if( !sim_supported( init ) ) {
+		fprintf(stderr, "ERROR: Pattern %s cannot be simulated.\n", pattern);
+		return 1;
+	}
+
+	for( size = pattern_size( init, (wset_start_size < min_size) ? min_size : wset_start_size ); size <= wset_final_size;
+	     size = pattern_size( init, next_size(size) ) )
+		work.num_points++;
+	work.points = (sim_point *) calloc( work.num_points, sizeof(sim_point) );
+	if( work.points == NULL )
+		return 1;
+	/* the largest points take longest, so they are started first */
+	i = work.num_points;
+	for( size = pattern_size( init, (wset_start_size < min_size) ? min_size : wset_start_size ); size <= wset_final_size;
+	     size = pattern_size( init, next_size(size) ) ) {
+		sim_point *pt = &work.points[--i];
+		pt->size = size;
+		pt->sampling = sim_sampling( init, size );
+		long int accesses = size / pattern_spacing( init ) / pt->sampling + 1;
+		/* the working set of the chain, the lap growing by doubling and the
+		 * caches storing tags and states */
+		pt->memory = size + elem_size + 2 * accesses * sizeof(uint64_t);
+		for( l = 0; l < num_sim_levels; l++ )
+			pt->memory += 2 * sim_levels[l].size / sim_line / pt->sampling * sizeof(uint64_t);
+	}
+
+	time_t starttime = time(NULL); /* calendar time */
+	fprintf( logfile, "# Starttime: %s", asctime( localtime(&starttime) ) );
+	fprintf( logfile, "# %s (simulated)\n", pattern );
+	fprintf( logfile, "# Kernel: read\n" );
+	fprintf( logfile, "# Element size: %ld Bytes\n", elem_size );
+	for( l = 0; l < num_sim_levels; l++ )
+		fprintf( logfile, "# L%d: %ld Bytes, %d ways, %d Byte lines, %s%s\n", l + 1, sim_levels[l].size, sim_levels[l].ways,
+		         sim_levels[l].line, sim_policy_names[sim_levels[l].policy], sim_levels[l].inclusive ? ", inclusive" : "" );
+	fprintf( logfile, "# %10s %8s", "size", "sampling" );
+	events_head();
+	fprintf( logfile, "\n" );
+	fflush( logfile );
+
+	if( num_threads_sim > work.num_points )
+		num_threads_sim = work.num_points;
+	if( num_threads_sim > MAX_INIT_THREADS )
+		num_threads_sim = MAX_INIT_THREADS;
+	for( t = 0; t < num_threads_sim; t++ )
+		started[t] = (pthread_create( &threads[t], NULL, sim_thread, &work ) == 0);
+	sim_thread( &work );
+	for( t = 0; t < num_threads_sim; t++ )
+		if( started[t] )
+			pthread_join( threads[t], NULL );
+
+	row_test = "simulate";
+	row_pattern = pattern;
+	row_kernel = "read";
+	for( i = work.num_points - 1; i >= 0; i-- ) {
+		sim_point *pt = &work.points[i];
+		if( pt->error ) {
+			fprintf(stderr, "ERROR: Simulation of %ld Bytes failed, out of memory.\n", pt->size);
+			error = 1;
+			break;
+		}
+		fprintf( logfile, "%12ld %8ld", pt->size, pt->sampling );
+		for( l = 0; l < num_sim_levels; l++ )
+			fprintf( logfile, " %14.4lf", pt->miss_rates[l] );
+		fprintf( logfile, "\n" );
+		result_row row = { pt->size, NAN, NAN, NAN, NAN, NAN, NULL, pt->miss_rates, -1, -1 };
+		report_row( &row );
+	}
+	free( work.points );
+	time_t endtime = time(NULL); /* calendar time */
+	fprintf( logfile, "# Endtime: %s", asctime( localtime(&endtime) ) );
+	fprintf( logfile, "# Duration: %lf sec\n\n\n", difftime(endtime, starttime) );
+	return error;
+}
+
+/**
+ * Write the names of the statistics columns if repetitions are enabled.
+ */
+void stats_head(const char *unit){
+	if( repetitions > 1 || ci_target > 0. ) {
+		char name[4][32];
+		snprintf( name[0], sizeof(name[0]), "min %s", unit );
+		snprintf( name[1], sizeof(name[1]), "mean %s", unit );
+		snprintf( name[2], sizeof(name[2]), "stddev %s", unit );
+		snprintf( name[3], sizeof(name[3]), "ci95 %s", unit );
+		fprintf( logfile, " %4s %10s %10s %10s %10s", "reps", name[0], name[1], name[2], name[3] );
+	}
+}
+
+void result_head(){
+	int t;
+	fprintf(logfile,"# %10s %10s %16s %8s %8s", "size", "etime", "access/sec", "ticks/access", "ns/access");
+	if( num_threads == 0 ) {
+		stats_head( "ticks" );
+		if( flush_mode != FLUSH_WARM )
+			fprintf(logfile, " %8s", "cold");
+		events_head();
+	}
+	for( t = 0; t < num_threads; t++ ) {
+		char name[32];
+		snprintf(name, sizeof(name), "th%d access/sec", t);
+		fprintf(logfile, " %16s", name);
+	}
+	fprintf(logfile, "\n");
+}
+
+int main( int argc, char* argv[] ){
+
+	int i;
+	long size;
+	long result = 0;
+	char logfilename[256];
+	const char *output = NULL;
+
+	typedef struct {
+		init_fct_ptr function;
+		char *name;
+		int execute;
+	} init_fct_spec;
+
+	typedef struct {
+		test_fct_ptr function;
+		chase_fct_ptr (*kernel)();
+		char *name;
+		int execute;
+	} test_fct_spec;
+
+	init_fct_spec init_functions[] = {
+		{init_sequential, "sequential", 1},
+		{init_inverse_sequential, "inverse-sequential", 1},
+		{init_random, "random", 1},
+		{init_inverse_random, "inverse-random", 0},
+		{init_page_sequential, "page-sequential", 0},
+		{init_page_random, "page-random", 0},
+		{init_page_shuffled, "page-shuffled", 0},
+		{init_trace, "trace", 0} /* enabled by trace:<file> */
+	};
+
+	test_fct_spec test_functions[] = {
+		{test_read, read_kernel, "read", 1},
+		{test_write, write_kernel, "write", 0},
+		{test_rmw, rmw_kernel, "rmw", 0},
+		{test_prefetch, prefetch_kernel, "prefetch", 0}
+	};
+
+	const char optstring[] = "a:b:c:he:k:m:M:p:r:s:t:";
+	enum { OPT_CPUS = 256, OPT_SHARED, OPT_DURATION, OPT_NUMA_MATRIX, OPT_SIMD, OPT_NT, OPT_LEVELS, OPT_CI, OPT_MLOCK, OPT_SEED, OPT_FLUSH, OPT_EVENTS, OPT_FORMAT, OPT_OUTPUT, OPT_COMPARE, OPT_THRESHOLD, OPT_PAGE_STRIDE, OPT_CONFLICT, OPT_PREFETCHER, OPT_PREFETCH_DISTANCE, OPT_LOADED, OPT_LOAD_KERNEL, OPT_LOAD_DELAYS, OPT_SIMULATE, OPT_ADAPTIVE };
+	int run_numa_matrix = 0;
+	int run_conflict = 0;
+	int run_prefetcher = 0;
+	int run_loaded = 0;
+	int run_simulate = 0;
+	int run_bandwidth = 0;
+	const char *simd = "auto";
+	const struct option longopts[] = {
+		{"cpus", required_argument, NULL, OPT_CPUS},
+		{"shared", no_argument, NULL, OPT_SHARED},
+		{"duration", required_argument, NULL, OPT_DURATION},
+		{"numa-matrix", no_argument, NULL, OPT_NUMA_MATRIX},
+		{"simd", required_argument, NULL, OPT_SIMD},
+		{"nt", no_argument, NULL, OPT_NT},
+		{"levels", no_argument, NULL, OPT_LEVELS},
+		{"ci", required_argument, NULL, OPT_CI},
+		{"mlock", no_argument, NULL, OPT_MLOCK},
+		{"seed", required_argument, NULL, OPT_SEED},
+		{"flush", required_argument, NULL, OPT_FLUSH},
+		{"events", required_argument, NULL, OPT_EVENTS},
+		{"format", required_argument, NULL, OPT_FORMAT},
+		{"output", required_argument, NULL, OPT_OUTPUT},
+		{"compare", required_argument, NULL, OPT_COMPARE},
+		{"threshold", required_argument, NULL, OPT_THRESHOLD},
+		{"page-stride", required_argument, NULL, OPT_PAGE_STRIDE},
+		{"conflict", optional_argument, NULL, OPT_CONFLICT},
+		{"prefetcher", optional_argument, NULL, OPT_PREFETCHER},
+		{"prefetch-distance", required_argument, NULL, OPT_PREFETCH_DISTANCE},
+		{"loaded", optional_argument, NULL, OPT_LOADED},
+		{"load-kernel", required_argument, NULL, OPT_LOAD_KERNEL},
+		{"load-delays", required_argument, NULL, OPT_LOAD_DELAYS},
+		{"simulate", optional_argument, NULL, OPT_SIMULATE},
+		{"adaptive", optional_argument, NULL, OPT_ADAPTIVE},
+		{NULL, 0, NULL, 0}
+	};
+
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, optstring, longopts, NULL)) != -1) {
+		switch(opt) {
+			case 'a':
+				for(i = 0; i < sizeof(alloc_policy_names)/sizeof(alloc_policy_names[0]); i++) {
+					if(strcmp(optarg, alloc_policy_names[i]) == 0)
+						break;
+				}
+				if(i == sizeof(alloc_policy_names)/sizeof(alloc_policy_names[0])) {
+					fprintf(stderr, "ERROR: Unknown allocation policy '%s'.\n", optarg);
+					exit(1);
+				}
+				alloc_policy = i;
+				break;
+			case 'b':
+				run_bandwidth = 0;
+				for(i = 0; i < BW_NUM_OPS; i++) {
+					bw_execute[i] = name_in_list(bw_op_names[i], optarg);
+					run_bandwidth |= bw_execute[i];
+				}
+				break;
+			case 'c':
+				num_chain_counts = parse_id_list(optarg, chain_counts, MAX_CHAINS);
+				if(num_chain_counts <= 0)
+					exit(1);
+				for(i = 0; i < num_chain_counts; i++) {
+					if(chain_counts[i] < 1 || chain_counts[i] > MAX_CHAINS) {
+						fprintf(stderr, "ERROR: Number of chains has to be between 1 and %d.\n", MAX_CHAINS);
+						exit(1);
+					}
+				}
+				break;
+			case 'e':
+				num_elem_sizes = parse_elem_sizes(optarg);
+				if(num_elem_sizes <= 0)
+					exit(1);
+				break;
+			case 'm':
+				wset_start_size = atol(optarg);
+				break;
+			case 'M':
+				wset_final_size = atol(optarg);
+				break;
+			case 'k':
+				for(i = 0; i < sizeof(test_functions)/sizeof(test_functions[0]); i++) {
+					test_functions[i].execute = name_in_list(test_functions[i].name, optarg);
+				}
+				break;
+			case 'p':
+				for(i = 0; i < sizeof(init_functions)/sizeof(init_functions[0]); i++) {
+					init_functions[i].execute = (init_functions[i].function != init_trace) && name_in_list(init_functions[i].name, optarg);
+				}
+				trace_file = strstr(optarg, "trace:");
+				if(trace_file != NULL) {
+					/* the file name extends to the end of the list */
+					trace_file += strlen("trace:");
+					for(i = 0; i < sizeof(init_functions)/sizeof(init_functions[0]); i++) {
+						if(init_functions[i].function == init_trace)
+							init_functions[i].execute = 1;
+					}
+				}
+				break;
+			case 'r':
+				repetitions = atoi(optarg);
+				break;
+			case 's':
+				wset_stride = atol(optarg);
+				break;
+			case 't':
+				num_threads = atoi(optarg);
+				break;
+			case OPT_CPUS:
+				num_thread_cpus = parse_id_list(optarg, thread_cpus, MAX_CPUS);
+				if(num_thread_cpus <= 0)
+					exit(1);
+				break;
+			case OPT_SHARED:
+				shared_chain = 1;
+				break;
+			case OPT_DURATION:
+				point_duration = atof(optarg);
+				break;
+			case OPT_NUMA_MATRIX:
+				run_numa_matrix = 1;
+				break;
+			case OPT_SIMD:
+				simd = optarg;
+				break;
+			case OPT_NT:
+				bw_nt = 1;
+				break;
+			case OPT_LEVELS:
+				detect_cache_levels = 1;
+				break;
+			case OPT_ADAPTIVE:
+				adaptive_threshold = (optarg != NULL) ? atof(optarg) : 0.1;
+				if(adaptive_threshold <= 0.) {
+					fprintf(stderr, "ERROR: The threshold of --adaptive has to be positive. (threshold=%s)\n", optarg);
+					exit(1);
+				}
+				break;
+			case OPT_CI:
+				ci_target = atof(optarg);
+				break;
+			case OPT_MLOCK:
+				arena_mlock = 1;
+				break;
+			case OPT_SEED:
+				random_seed = strtoull(optarg, NULL, 0);
+				break;
+			case OPT_FLUSH:
+				for(i = 0; i < sizeof(flush_mode_names)/sizeof(flush_mode_names[0]); i++) {
+					if(strcmp(optarg, flush_mode_names[i]) == 0)
+						break;
+				}
+				if(i == sizeof(flush_mode_names)/sizeof(flush_mode_names[0])) {
+					fprintf(stderr, "ERROR: Unknown cache flush mode '%s'.\n", optarg);
+					exit(1);
+				}
+				flush_mode = i;
+				break;
+			case OPT_EVENTS:
+				if(parse_events(optarg) < 0)
+					exit(1);
+				break;
+			case OPT_FORMAT:
+				for(i = 0; i < sizeof(format_names)/sizeof(format_names[0]); i++) {
+					if(strcmp(optarg, format_names[i]) == 0)
+						break;
+				}
+				if(i == sizeof(format_names)/sizeof(format_names[0])) {
+					fprintf(stderr, "ERROR: Unknown output format '%s'.\n", optarg);
+					exit(1);
+				}
+				output_format = i;
+				break;
+			case OPT_OUTPUT:
+				output = optarg;
+				break;
+			case OPT_COMPARE:
+				if(load_baseline(optarg) != 0)
+					exit(1);
+				break;
+			case OPT_THRESHOLD:
+				regression_threshold = atof(optarg);
+				break;
+			case OPT_PAGE_STRIDE:
+				page_stride = atol(optarg);
+				break;
+			case OPT_CONFLICT:
+				num_conflict_strides = parse_conflict_strides(optarg);
+				if(num_conflict_strides < 0)
+					exit(1);
+				run_conflict = 1;
+				break;
+			case OPT_PREFETCHER:
+				num_prefetch_strides = parse_prefetch_strides(optarg);
+				if(num_prefetch_strides < 0)
+					exit(1);
+				run_prefetcher = 1;
+				break;
+			case OPT_PREFETCH_DISTANCE:
+				prefetch_distance = atol(optarg);
+				break;
+			case OPT_LOADED:
+				num_load_threads = (optarg != NULL) ? atoi(optarg) : 0;
+				run_loaded = 1;
+				break;
+			case OPT_LOAD_KERNEL:
+				for(i = 0; i < BW_NUM_OPS; i++) {
+					if(strcmp(optarg, bw_op_names[i]) == 0)
+						break;
+				}
+				if(i == BW_NUM_OPS) {
+					fprintf(stderr, "ERROR: Unknown load kernel '%s'.\n", optarg);
+					exit(1);
+				}
+				load_op = i;
+				break;
+			case OPT_LOAD_DELAYS:
+				num_load_delays = parse_load_delays(optarg);
+				if(num_load_delays < 0)
+					exit(1);
+				break;
+			case OPT_SIMULATE:
+				num_sim_levels = parse_sim_config(optarg);
+				if(num_sim_levels < 0)
+					exit(1);
+				run_simulate = 1;
+				break;
+			case 'h':
+			default:
+				fprintf(stderr, "Usage: %s [-a alloc_policy [--mlock]] [-b bw_kernel [--simd isa] [--nt]] [-c chains] [-e elem_size[,elem_size...]] [-k kernel] [-m min] [-M max] [-p pattern[,trace:file] [--page-stride bytes]] [-r repetitions [--ci rel_width]] [-s stride] [--seed n]\n"
+				                "       [--flush mode] [--events list] [--format log|csv|json] [--output path]\n"
+				                "       [--compare baseline.csv [--threshold rel]] [-t threads [--cpus list] [--shared]] [--duration sec] [--numa-matrix] [--levels] [--adaptive[=rel]]\n"
+				                "       [--conflict[=stride,...]] [--prefetcher[=stride,...]] [--prefetch-distance accesses]\n"
+				                "       [--loaded[=threads] [--load-kernel bw_kernel] [--load-delays ticks,...]] [--simulate[=size:ways[:line][:lru|plru][:inclusive],...]]\n", argv[0]);
+				fprintf(stderr, "--conflict probes the associativity with power of two strides, by default the set aliasing distances of the caches.\n");
+				fprintf(stderr, "--prefetcher times strided chases of the max. size forward, backward and page-shuffled against the random chase.\n");
+				fprintf(stderr, "--prefetch-distance sets how many accesses ahead the prefetch kernel prefetches (default 8).\n");
+				fprintf(stderr, "--loaded measures the random chase latency while load threads (default one per further CPU) stream a bandwidth kernel throttled by each delay.\n");
+				fprintf(stderr, "--adaptive measures a coarse sweep and bisects the intervals whose latency changes by more than rel (default 0.1).\n");
+				fprintf(stderr, "--simulate predicts the miss rates of the patterns for a cache hierarchy, by default the one in sysfs with LRU.\n");
+				fprintf(stderr, "With --compare the exit status is 2 if a point regressed by more than the threshold (default 0.05).\n");
+				fprintf(stderr, "Available memory traversal patterns:\n");
+				for(i = 0; i < sizeof(init_functions)/sizeof(init_functions[0]); i++) {
+					if(init_functions[i].function == init_trace)
+						fprintf(stderr, "* trace:file (replays 64 bit offsets or addresses, last in the list, read kernel only)\n");
+					else
+						fprintf(stderr, "* %s\n", init_functions[i].name);
+				}
+				fprintf(stderr, "Available allocation policies:\n");
+				for(i = 0; i < sizeof(alloc_policy_names)/sizeof(alloc_policy_names[0]); i++) {
+					fprintf(stderr, "* %s\n", alloc_policy_names[i]);
+				}
+				fprintf(stderr, "Available cache flush modes (--flush, default evict):\n");
+				for(i = 0; i < sizeof(flush_mode_names)/sizeof(flush_mode_names[0]); i++) {
+					fprintf(stderr, "* %s\n", flush_mode_names[i]);
+				}
+				fprintf(stderr, "Available events (--events, or r<hex> for raw events):\n");
+				for(i = 0; i < sizeof(perf_event_names)/sizeof(perf_event_names[0]); i++) {
+					fprintf(stderr, "* %s\n", perf_event_names[i].name);
+				}
+				fprintf(stderr, "Available bandwidth kernels (-b, replaces the latency tests):\n");
+				for(i = 0; i < BW_NUM_OPS; i++) {
+					fprintf(stderr, "* %s\n", bw_op_names[i]);
+				}
+				fprintf(stderr, "Available SIMD instruction sets (--simd, default auto):\n");
+				for(i = 0; i < sizeof(bw_isas)/sizeof(bw_isas[0]); i++) {
+					fprintf(stderr, "* %s%s\n", bw_isas[i].name, bw_isa_supported(i) ? "" : " (not supported)");
+				}
+				fprintf(stderr, "Available access kernels:\n");
+				for(i = 0; i < sizeof(test_functions)/sizeof(test_functions[0]); i++) {
+					fprintf(stderr, "* %s\n", test_functions[i].name);
+				}
+				exit(1);
+				break;
+		}
+	}
+
+	if(repetitions < 1 || repetitions > MAX_REPETITIONS || ci_target < 0.) {
+		fprintf(stderr, "ERROR: Repetitions have to be between 1 and %d. (repetitions=%d, ci=%lf)\n", MAX_REPETITIONS, repetitions, ci_target);
+		exit(1);
+	}
+	if(num_threads < 0 || point_duration <= 0.) {
+		fprintf(stderr, "ERROR: Invalid number of threads or duration. (threads=%d, duration=%lf)\n", num_threads, point_duration);
+		exit(1);
+	}
+	for(i = 0; i < num_chain_counts; i++) {
+		int k;
+		for(k = 0; k < sizeof(test_functions)/sizeof(test_functions[0]); k++) {
+			if(chain_counts[i] > 1 && test_functions[k].execute && (num_threads > 0 || test_functions[k].function != test_read)) {
+				fprintf(stderr, "ERROR: Multiple chains (-c) are only supported by the single threaded read kernel.\n");
+				exit(1);
+			}
+		}
+	}
+	bw_isa = select_bw_isa(simd);
+	if(run_bandwidth && num_threads > 0) {
+		fprintf(stderr, "ERROR: Bandwidth kernels (-b) run single threaded, for concurrent streams use --loaded.\n");
+		exit(1);
+	}
+	if(run_bandwidth && bw_isa < 0) {
+		fprintf(stderr, "ERROR: SIMD instruction set '%s' is unknown or not supported.\n", simd);
+		exit(1);
+	}
+	if(flush_mode == FLUSH_CLFLUSHOPT && !clflushopt_supported()) {
+		fprintf(stderr, "ERROR: clflushopt is not supported by this CPU.\n");
+		exit(1);
+	}
+#if !defined(__x86_64__) && !defined(__i386__)
+	if(flush_mode == FLUSH_CLFLUSH) {
+		fprintf(stderr, "ERROR: clflush is only available on x86.\n");
+		exit(1);
+	}
+#endif
+	/* only the latency sweeps, probes and the NUMA matrix clear the caches */
+	if(flush_mode == FLUSH_EVICT && !run_bandwidth && !run_simulate && !run_loaded && alloc_evict_buffer() != 0) {
+		exit(1);
+	}
+	if(run_conflict && (num_threads > 0 || run_bandwidth || run_numa_matrix)) {
+		fprintf(stderr, "ERROR: The conflict probe (--conflict) can not be combined with threads, bandwidth kernels or the NUMA matrix.\n");
+		exit(1);
+	}
+	if(run_prefetcher && (num_threads > 0 || run_bandwidth || run_numa_matrix || run_conflict)) {
+		fprintf(stderr, "ERROR: The prefetcher study (--prefetcher) can not be combined with threads, bandwidth kernels, the NUMA matrix or the conflict probe.\n");
+		exit(1);
+	}
+	if(run_loaded && (num_threads > 0 || run_bandwidth || run_numa_matrix || run_conflict || run_prefetcher || num_events > 0)) {
+		fprintf(stderr, "ERROR: The loaded latency (--loaded) can not be combined with threads, bandwidth kernels, the NUMA matrix, the conflict probe, the prefetcher study or events.\n");
+		exit(1);
+	}
+	if(run_simulate && (num_threads > 0 || run_bandwidth || run_numa_matrix || run_conflict || run_prefetcher || run_loaded || num_events > 0
+	   || num_chain_counts > 1 || chain_counts[0] > 1)) {
+		fprintf(stderr, "ERROR: The simulation (--simulate) can not be combined with threads, bandwidth kernels, the NUMA matrix, the conflict probe, the prefetcher study, the loaded latency, events or several chains.\n");
+		exit(1);
+	}
+	if(run_simulate && trace_file != NULL) {
+		fprintf(stderr, "ERROR: The trace pattern can not be simulated (--simulate), it has no chain.\n");
+		exit(1);
+	}
+	if(run_loaded && bw_isa < 0) {
+		fprintf(stderr, "ERROR: SIMD instruction set '%s' is unknown or not supported.\n", simd);
+		exit(1);
+	}
+	for(i = 0; i < sizeof(test_functions)/sizeof(test_functions[0]); i++) {
+		if(test_functions[i].execute && test_functions[i].function == test_prefetch && num_threads > 0) {
+			fprintf(stderr, "ERROR: The prefetch kernel is only supported single threaded.\n");
+			exit(1);
+		}
+	}
+	if(trace_file != NULL) {
+		if(num_threads > 0 || num_events > 0 || num_chain_counts > 1 || chain_counts[0] > 1) {
+			fprintf(stderr, "ERROR: The trace pattern is only supported single threaded with one chain and without events.\n");
+			exit(1);
+		}
+		for(i = 0; i < num_elem_sizes; i++) {
+			if(wset_final_size / elem_sizes[i] > UINT32_MAX) {
+				fprintf(stderr, "ERROR: The trace pattern supports at most %u elements per working set. (elem_size=%ld)\n", UINT32_MAX, elem_sizes[i]);
+				exit(1);
+			}
+		}
+		if(open_trace(trace_file) != 0)
+			exit(1);
+	}
+	if(prefetch_distance < 0) {
+		fprintf(stderr, "ERROR: Invalid prefetch distance. (prefetch_distance=%ld)\n", prefetch_distance);
+		exit(1);
+	}
+	if(num_events > 0 && (num_threads > 0 || run_bandwidth || run_numa_matrix)) {
+		fprintf(stderr, "ERROR: Events (--events) are only supported by the single threaded latency tests.\n");
+		exit(1);
+	}
+	if(num_events > 0 && open_events() != 0) {
+		exit(1);
+	}
+	if(run_simulate)
+		sim_events();
+	calibrate_tsc();
+	if((num_threads > 0 || run_loaded) && num_thread_cpus == 0) {
+		num_thread_cpus = default_cpu_list();
+	}
+	if(num_threads > sysconf(_SC_NPROCESSORS_ONLN))
+		fprintf(stderr, "WARNING: %d threads oversubscribe the %ld online CPUs.\n", num_threads, sysconf(_SC_NPROCESSORS_ONLN));
+	else if(num_threads > num_thread_cpus && num_thread_cpus > 0)
+		fprintf(stderr, "WARNING: %d threads share the %d CPUs they are pinned to.\n", num_threads, num_thread_cpus);
+	if(run_loaded) {
+		if(num_load_threads == 0)
+			num_load_threads = (num_thread_cpus > 1) ? num_thread_cpus - 1 : 1;
+		if(num_load_threads < 1 || num_load_threads > MAX_CPUS) {
+			fprintf(stderr, "ERROR: Invalid number of load threads. (threads=%d)\n", num_load_threads);
+			exit(1);
+		}
+		if(num_load_threads >= num_thread_cpus)
+			fprintf(stderr, "WARNING: %d load threads and the latency thread share %d CPUs.\n", num_load_threads, num_thread_cpus);
+	}
+
+	for(i = 0; i < num_elem_sizes; i++) {
+		if(page_stride < (elem_sizes[i] + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE) {
+			fprintf(stderr, "ERROR: Page stride has to hold an element rounded to cache lines. (page_stride=%ld, elem_size=%ld)\n", page_stride, elem_sizes[i]);
+			exit(1);
+		}
+	}
+	if(wset_start_size < wset_stride) {
+		fprintf(stderr, "ERROR: Stride has to be larger than the minumum size. (stride=%ld, min_size=%ld)\n", wset_stride, wset_start_size);
+		exit(1);
+	}
+
+	/* the log is always written, --output names the file of the chosen format */
+	if(output_format == FORMAT_LOG && output != NULL)
+		snprintf(logfilename, sizeof(logfilename), "%s", output);
+	else
+		snprintf(logfilename, sizeof(logfilename), "%s.log", argv[0]);
+	logfile = fopen(logfilename, "w+");
+	if(logfile == NULL) {
+		fprintf(stderr, "ERROR: Could not open log file '%s': %s\n", logfilename, strerror(errno));
+		exit(1);
+	}
+	if(output_format != FORMAT_LOG) {
+		char outfilename[256];
+		if(output != NULL)
+			snprintf(outfilename, sizeof(outfilename), "%s", output);
+		else
+			snprintf(outfilename, sizeof(outfilename), "%s.%s", argv[0], format_names[output_format]);
+		outfile = fopen(outfilename, "w");
+		if(outfile == NULL) {
+			fprintf(stderr, "ERROR: Could not open output file '%s': %s\n", outfilename, strerror(errno));
+			exit(1);
+		}
+		atexit(output_end);
+	}
+	collect_machine_info();
+
+#ifdef PAPI
+	int retval;
+	retval = PAPI_library_init(PAPI_VER_CURRENT);
+	if (retval != PAPI_VER_CURRENT) {
+		fprintf(stderr,"PAPI library init error!\n");
 		papi_error_handler(retval);
 	}	
 	retval = PAPI_start_counters(Events, num_hwcntrs);
@@ -389,39 +5228,173 @@ int main( int argc, char* argv[] ){
 	fprintf(logfile, "# ------------------------------\n" );
 	fprintf(logfile, "# Cache-Analysis\n");
 	fprintf(logfile, "# Logfilename:    %s\n", logfilename);
-	fprintf(logfile, "# Access padding: %ld Bytes\n", NPAD * sizeof(char) );
-	fprintf(logfile, "# Struct size:    %ld Bytes\n", sizeof(list_elem));
+	fprintf(logfile, "# Host:           %s\n", machine.hostname);
+	fprintf(logfile, "# CPU model:      %s\n", machine.cpu_model);
+	fprintf(logfile, "# Governor:       %s\n", machine.governor);
+	fprintf(logfile, "# THP:            %s\n", machine.thp);
+	fprintf(logfile, "# Kernel:         %s\n", machine.kernel);
+	fprintf(logfile, "# NUMA nodes:     %s\n", machine.numa_nodes);
+	fprintf(logfile, "# Element sizes: ");
+	for(i = 0; i < num_elem_sizes; i++) {
+		fprintf(logfile, " %ld", elem_sizes[i]);
+	}
+	fprintf(logfile, " Bytes\n");
+	fprintf(logfile, "# Allocation:     %s%s\n", alloc_policy_names[alloc_policy], arena_mlock ? " (locked)" : "");
+	if(evict_buffer != NULL)
+		fprintf(logfile, "# Cache flush:    %s (%ld Bytes)", flush_mode_names[flush_mode], evict_size);
+	else
+		fprintf(logfile, "# Cache flush:    %s", flush_mode_names[flush_mode]);
+	if(flush_mode == FLUSH_WARM)
+		fprintf(logfile, ", all accesses warm\n");
+	else if(num_threads > 0)
+		fprintf(logfile, ", only the first traversal of each thread is cold\n");
+	else
+		fprintf(logfile, ", one cold traversal per point in column cold, then warm\n");
+	if(num_threads > 0) {
+		fprintf(logfile, "# Threads:        %d (%s chain%s)\n", num_threads,
+		        shared_chain ? "shared" : "private", shared_chain ? "" : "s");
+		fprintf(logfile, "# CPUs:          ");
+		for(i = 0; i < num_threads; i++) {
+			fprintf(logfile, " %d", thread_cpus[i % num_thread_cpus]);
+		}
+		fprintf(logfile, "\n");
+	}
 	fprintf(logfile, "# wset_start_size:    %ld Bytes\n", wset_start_size);
 	fprintf(logfile, "# wset_final_size:    %ld Bytes\n", wset_final_size);
 	fprintf(logfile, "# wset_stride:    %ld elements\n", wset_stride);
-	fprintf(logfile, "# # accesses:     %ld\n", NUM_ACCESS_FACTOR * wset_final_size / sizeof( list_elem * ));
+	fprintf(logfile, "# page_stride:    %ld Bytes\n", page_stride);
+	if(adaptive_threshold > 0.)
+		fprintf(logfile, "# Adaptive:       threshold %.3lf, coarse factor %.2lf, resolution %.2lf\n", adaptive_threshold,
+		        (double) ADAPTIVE_COARSE_FACTOR, factor);
+	fprintf(logfile, "# Prefetch distance: %ld accesses\n", prefetch_distance);
+	if(trace_file != NULL)
+		fprintf(logfile, "# Trace:          %s (%ld entries, range %llu Bytes, window %ld entries, offsets %ld Bytes)\n", trace_file,
+		        trace_len, (unsigned long long) (trace_max - trace_min), trace_window, trace_window * (long) sizeof(uint32_t));
+	fprintf(logfile, "# Random seed:    %llu\n", (unsigned long long) random_seed);
+	fprintf(logfile, "# TSC frequency:  %.3lf GHz\n", tsc_ghz);
+	fprintf(logfile, "# Time per point: %lf sec (at least %d accesses per element)\n", point_duration, NUM_ACCESS_FACTOR);
 	fprintf(logfile, "# ------------------------------\n\n" );
 	fflush (logfile);
+	output_begin(argc, argv);
 
-	for(i = 0; i < sizeof(init_functions)/sizeof(init_functions[0]); i++) {
-		if(init_functions[i].execute == 0) {
-			continue;
-		}
-		time_t starttime = time(NULL); /* calendar time */
-		fprintf( logfile, "# Starttime: %s", asctime( localtime(&starttime) ) );
-		fprintf( logfile, "# %s\n", init_functions[i].name );
-		result_head();
-		for( size = wset_start_size; size <= wset_final_size; ) {
-			wsetptr = init_functions[i].function( size );
-			result += test_read( size, wsetptr );
-			free( wsetptr );
-			if(size < SMALL_ARRAY_LIMIT) {
-				size += sizeof(list_elem);
+	/* the arena is released at exit */
+	if( (!run_numa_matrix && !run_simulate) || run_bandwidth ) {
+		elem_size = elem_sizes[0];
+		if( alloc_arena() != 0 )
+			return 1;
+	}
+
+	if( run_bandwidth ) {
+		fprintf(logfile, "# SIMD:           %s%s\n\n", bw_isas[bw_isa].name, bw_nt ? " (non-temporal stores)" : "");
+		fprintf(stdout, "# kernel level from to GB/s ticks/Byte\n");
+		for(i = 0; i < BW_NUM_OPS; i++) {
+			if(bw_execute[i] == 0) {
+				continue;
 			}
-			else {
-				size *= factor;
+			time_t starttime = time(NULL); /* calendar time */
+			fprintf( logfile, "# Starttime: %s", asctime( localtime(&starttime) ) );
+			fprintf( logfile, "# bandwidth %s\n", bw_op_names[i] );
+			row_test = "bandwidth";
+			row_pattern = "stream";
+			row_kernel = bw_op_names[i];
+			fprintf( logfile, "# %10s %10s %16s %8s", "size", "etime", "GB/s", "ticks/Byte" );
+			stats_head( "GB/s" );
+			fprintf( logfile, "\n" );
+			num_sweep_points = 0;
+			/* smaller arrays do not allow meaningful streaming */
+			for( size = (wset_start_size < SMALL_ARRAY_LIMIT) ? SMALL_ARRAY_LIMIT : wset_start_size; size <= wset_final_size; size = next_size(size) ) {
+				/* neighbouring sizes rounding to the same arrays are measured once */
+				if( num_sweep_points > 0 && bw_bytes( size, i ) == sweep_points[num_sweep_points - 1].size )
+					continue;
+				result += test_bandwidth( size, i );
 			}
-			//size = (size + sizeof(list_elem) > size * factor) ? size + sizeof(list_elem) : size * factor;
+			fprintf( logfile, "# Result: %ld\n", result );
+			report_bw_levels( bw_op_names[i] );
+			time_t endtime = time(NULL); /* calendar time */
+			fprintf( logfile, "# Endtime: %s", asctime( localtime(&endtime) ) );
+			fprintf( logfile, "# Duration: %lf sec\n\n\n", difftime(endtime, starttime) );
 		}
+		return compare_summary();
+	}
+
+	if( run_numa_matrix ) {
+		elem_size = elem_sizes[0];
+		if( numa_matrix() != 0 )
+			return 1;
+		return compare_summary();
+	}
+
+	if( run_conflict ) {
+		elem_size = elem_sizes[0];
+		fprintf(stdout, "# elem_size stride level ways sysfs_ways penalty_ticks penalty_ns\n");
+		result += conflict_probe();
 		fprintf( logfile, "# Result: %ld\n", result );
-		time_t endtime = time(NULL); /* calendar time */
-		fprintf( logfile, "# Endtime: %s", asctime( localtime(&endtime) ) );
-		fprintf( logfile, "# Duration: %lf sec\n\n\n", difftime(endtime, starttime) );
+		return compare_summary();
+	}
+
+	if( run_loaded ) {
+		long int ret;
+		elem_size = elem_sizes[0];
+		fprintf(logfile, "# SIMD:           %s%s\n\n", bw_isas[bw_isa].name, bw_nt ? " (non-temporal stores)" : "");
+		fprintf(stdout, "# level size delay load_GB/s ticks/access ns/access\n");
+		ret = loaded_latency();
+		if( ret == -1 )
+			return 1;
+		fprintf( logfile, "# Result: %ld\n", ret );
+		return compare_summary();
+	}
+
+	if( run_simulate ) {
+		int e;
+		for(e = 0; e < num_elem_sizes; e++) {
+			elem_size = elem_sizes[e];
+			for(i = 0; i < sizeof(init_functions)/sizeof(init_functions[0]); i++) {
+				if(init_functions[i].execute == 0)
+					continue;
+				if(simulate_sweep(init_functions[i].name, init_functions[i].function) != 0)
+					return 1;
+			}
+		}
+		return compare_summary();
+	}
+
+	if( run_prefetcher ) {
+		elem_size = elem_sizes[0];
+		fprintf(stdout, "# variant elem_size stride ticks/access ns/access vs_random prefetched\n");
+		result += prefetcher_study();
+		fprintf( logfile, "# Result: %ld\n", result );
+		return compare_summary();
+	}
+
+	if( detect_cache_levels ) {
+		fprintf(stdout, "# pattern kernel elem_size chains level capacity ticks/access ns/access sysfs_size\n");
+	}
+
+	int e, k, n;
+	for(e = 0; e < num_elem_sizes; e++) {
+		elem_size = elem_sizes[e];
+		for(n = 0; n < num_chain_counts; n++) {
+			num_chains = chain_counts[n];
+			for(i = 0; i < sizeof(init_functions)/sizeof(init_functions[0]); i++) {
+				if(init_functions[i].execute == 0) {
+					continue;
+				}
+				for(k = 0; k < sizeof(test_functions)/sizeof(test_functions[0]); k++) {
+					test_fct_ptr test = test_functions[k].function;
+					if(test_functions[k].execute == 0) {
+						continue;
+					}
+					/* the trace is replayed by its own read kernel */
+					if(init_functions[i].function == init_trace) {
+						if(test != test_read)
+							continue;
+						test = test_trace;
+					}
+					result += sweep( init_functions[i].name, init_functions[i].function,
+					                 test_functions[k].name, test, test_functions[k].kernel );
+				}
+			}
+		}
 	}
 
 #ifdef PAPI
@@ -433,5 +5406,5 @@ int main( int argc, char* argv[] ){
 	}
 #endif
 
-	return 0;
+	return compare_summary();
 }
@@ -1,13 +1,55 @@
 #ifndef TIMER_H
 #define TIMER_H
 
-#include "sys/time.h"
+#include <time.h>
 #include <stdlib.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifndef CLOCK_MONOTONIC_RAW
+#define CLOCK_MONOTONIC_RAW CLOCK_MONOTONIC
+#endif
+
+/** @return seconds of a monotonic clock not adjusted by NTP */
+static inline double timer(){
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+  return (double) ts.tv_sec + (double) ts.tv_nsec / 1.0e9;
+}
 
-inline double timer(){
-  struct timeval timer;
-  gettimeofday(&timer, NULL);
-  return (double) timer.tv_sec + (double) timer.tv_usec / 1.0e6;
+/**
+ * Read the time stamp counter at the begin of a measured region. The fences
+ * keep preceding instructions from finishing after and following ones from
+ * starting before the read. Without a time stamp counter nanoseconds are
+ * returned.
+ */
+static inline unsigned long long tsc_begin(){
+#if defined(__x86_64__) || defined(__i386__)
+  unsigned long long t;
+  _mm_lfence();
+  t = __rdtsc();
+  _mm_lfence();
+  return t;
+#else
+  return (unsigned long long) (timer() * 1.0e9);
+#endif
+}
+
+/**
+ * Read the time stamp counter at the end of a measured region. rdtscp waits
+ * for all preceding instructions, the fence keeps following ones from
+ * starting before the read.
+ */
+static inline unsigned long long tsc_end(){
+#if defined(__x86_64__) || defined(__i386__)
+  unsigned int aux;
+  unsigned long long t = __rdtscp(&aux);
+  _mm_lfence();
+  return t;
+#else
+  return (unsigned long long) (timer() * 1.0e9);
+#endif
 }
 
 #endif